@@ -1,6 +1,15 @@
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <thread>
 #include "common.h"
 #include "app.h"
 #include "db.h"
+#include "http_client_pool.h"
+#include "rate_limiter.h"
+#include "response_cache.h"
 
 namespace bs {
 
@@ -90,106 +99,305 @@ bool LoadConfig() {
     return false;
   }
 
+  // Optional. It may be omitted in configs created by previous versions.
+  const int sync_concurrency =
+      v.has_field(kCfgSyncConcurrency) && !v.at(kCfgSyncConcurrency).is_null()
+      ? v.at(kCfgSyncConcurrency).as_integer()
+      : kDefaultSyncConcurrency;
+
+  if (sync_concurrency < 1) {
+    std::cout << "Error: " << kCfgSyncConcurrency << " must be a positive integer in " << kConfigFile << "."
+              << std::endl;
+    return false;
+  }
+
+  app_config.kSyncConcurrency = sync_concurrency;
+
+  const int status_update_concurrency =
+      v.has_field(kCfgStatusUpdateConcurrency) && !v.at(kCfgStatusUpdateConcurrency).is_null()
+      ? v.at(kCfgStatusUpdateConcurrency).as_integer()
+      : kDefaultStatusUpdateConcurrency;
+
+  if (status_update_concurrency < 1) {
+    std::cout << "Error: " << kCfgStatusUpdateConcurrency << " must be a positive integer in " << kConfigFile << "."
+              << std::endl;
+    return false;
+  }
+
+  app_config.kStatusUpdateConcurrency = status_update_concurrency;
+
+  const int full_sync_interval =
+      v.has_field(kCfgFullSyncInterval) && !v.at(kCfgFullSyncInterval).is_null()
+      ? v.at(kCfgFullSyncInterval).as_integer()
+      : kDefaultFullSyncInterval;
+
+  if (full_sync_interval < 0) {
+    std::cout << "Error: " << kCfgFullSyncInterval << " must not be negative in " << kConfigFile << "."
+              << std::endl;
+    return false;
+  }
+
+  app_config.kFullSyncInterval = full_sync_interval;
+
+  const int bamboohr_cache_ttl =
+      v.has_field(kCfgBambooHrCacheTTL) && !v.at(kCfgBambooHrCacheTTL).is_null()
+      ? v.at(kCfgBambooHrCacheTTL).as_integer()
+      : kDefaultBambooHrCacheTTL;
+
+  if (bamboohr_cache_ttl < 0) {
+    std::cout << "Error: " << kCfgBambooHrCacheTTL << " must not be negative in " << kConfigFile << "."
+              << std::endl;
+    return false;
+  }
+
+  app_config.kBambooHrCacheTTL = bamboohr_cache_ttl;
+
+  app_config.kBambooHrCachePersistent =
+      v.has_field(kCfgBambooHrCachePersistent) && !v.at(kCfgBambooHrCachePersistent).is_null()
+      ? v.at(kCfgBambooHrCachePersistent).as_bool()
+      : false;
+
+  const std::string db_sync =
+      v.has_field(kCfgDbSync) && !v.at(kCfgDbSync).is_null()
+      ? v.at(kCfgDbSync).as_string()
+      : "batch";
+
+  if (!kDbSyncModes.count(db_sync)) {
+    std::cout << "Error: " << kCfgDbSync << " must be one of none, batch or always in " << kConfigFile << "."
+              << std::endl;
+    return false;
+  }
+
+  app_config.kDbSync = kDbSyncModes.at(db_sync);
+
+  app_config.kDbBackend =
+      v.has_field(kCfgDbBackend) && !v.at(kCfgDbBackend).is_null()
+      ? v.at(kCfgDbBackend).as_string()
+      : kStorageLevelDb;
+
+  if (!IsStorageAvailable(app_config.kDbBackend)) {
+    std::cout << "Error: " << kCfgDbBackend << " " << app_config.kDbBackend
+              << " is not supported by this build in " << kConfigFile << "." << std::endl;
+    return false;
+  }
+
+  app_config.kDbPath =
+      v.has_field(kCfgDbPath) && !v.at(kCfgDbPath).is_null()
+      ? v.at(kCfgDbPath).as_string()
+      : kDbName;
+
+  const int install_callback_ttl =
+      v.has_field(kCfgInstallCallbackTTL) && !v.at(kCfgInstallCallbackTTL).is_null()
+      ? v.at(kCfgInstallCallbackTTL).as_integer()
+      : kDefaultInstallCallbackTTL;
+
+  if (install_callback_ttl <= 0) {
+    std::cout << "Error: " << kCfgInstallCallbackTTL << " must be positive in " << kConfigFile << "."
+              << std::endl;
+    return false;
+  }
+
+  app_config.kInstallCallbackTTL = install_callback_ttl;
+
+  const int64_t db_block_cache_size =
+      v.has_field(kCfgDbBlockCacheSize) && !v.at(kCfgDbBlockCacheSize).is_null()
+      ? v.at(kCfgDbBlockCacheSize).as_number().to_int64()
+      : static_cast<int64_t>(kDefaultDbBlockCacheSize);
+
+  if (db_block_cache_size <= 0) {
+    std::cout << "Error: " << kCfgDbBlockCacheSize << " must be positive in " << kConfigFile << "." << std::endl;
+    return false;
+  }
+
+  app_config.kDbBlockCacheSize = db_block_cache_size;
+
+  const int db_bloom_filter_bits =
+      v.has_field(kCfgDbBloomFilterBits) && !v.at(kCfgDbBloomFilterBits).is_null()
+      ? v.at(kCfgDbBloomFilterBits).as_integer()
+      : kDefaultDbBloomFilterBits;
+
+  if (db_bloom_filter_bits < 0) {
+    std::cout << "Error: " << kCfgDbBloomFilterBits << " must not be negative in " << kConfigFile << "."
+              << std::endl;
+    return false;
+  }
+
+  app_config.kDbBloomFilterBits = db_bloom_filter_bits;
+
+  const std::string db_compression =
+      v.has_field(kCfgDbCompression) && !v.at(kCfgDbCompression).is_null()
+      ? v.at(kCfgDbCompression).as_string()
+      : "snappy";
+
+  if (db_compression != "snappy" && db_compression != "none") {
+    std::cout << "Error: " << kCfgDbCompression << " must be one of snappy or none in " << kConfigFile << "."
+              << std::endl;
+    return false;
+  }
+
+  app_config.kDbCompression = db_compression == "snappy";
+
+  const int64_t db_write_buffer_size =
+      v.has_field(kCfgDbWriteBufferSize) && !v.at(kCfgDbWriteBufferSize).is_null()
+      ? v.at(kCfgDbWriteBufferSize).as_number().to_int64()
+      : static_cast<int64_t>(kDefaultDbWriteBufferSize);
+
+  if (db_write_buffer_size <= 0) {
+    std::cout << "Error: " << kCfgDbWriteBufferSize << " must be positive in " << kConfigFile << "." << std::endl;
+    return false;
+  }
+
+  app_config.kDbWriteBufferSize = db_write_buffer_size;
+
   return true;
 }
 
-void SyncUserProfileStatuses() {
-  std::map<std::string, web::json::value> teams;
+/// @brief Keeps a bounded number of pending profile status updates of a team.
+/// Every update is waited for, even if the team synchronization is interrupted by an exception.
+class StatusUpdateWindow {
+ public:
+  /// @param slack_team_id Slack team ID
+  /// @param size The maximum number of updates in flight
+  StatusUpdateWindow(const std::string& slack_team_id, const std::size_t size)
+      : slack_team_id(slack_team_id), size(size) {}
+
+  ~StatusUpdateWindow() {
+    Drain();
+  }
 
-  if (!DB::GetInstance().GetOrgs(&teams)) {
-    LOG(ERROR) << "Could not retrieve a list of organizations from database";
+  /// @brief Adds a new update waiting for the oldest one if the window is full
+  /// @param slack_id Slack user identifier
+  /// @param task A task of the update
+  /// @param on_success A callback which is invoked on the calling thread once the update has succeeded
+  void Push(const std::string& slack_id, pplx::task<void>&& task, std::function<void()>&& on_success) {
+    if (pending.size() >= size) {
+      JoinFront();
+    }
+    pending.push_back({slack_id, std::move(task), std::move(on_success)});
+  }
+
+  /// @brief Waits for all pending updates
+  void Drain() {
+    while (!pending.empty()) {
+      JoinFront();
+    }
+  }
+
+ private:
+  /// @brief Waits for the oldest update. A failed update is only logged so it does not affect the others.
+  void JoinFront() {
+    auto& update = pending.front();
+
+    try {
+      update.task.get();
+      update.on_success();
+    } catch (std::exception& e) {
+      LOG(ERROR) << "Unable to set status for " << update.slack_id << " in " << slack_team_id << ": " << e.what();
+    }
+    pending.pop_front();
   }
 
-  // Retrieves who is out data for all organizations one by one
-  for (const auto& [slack_team_id, org_val] : teams) {
-    std::string slack_admin_user_id = org_val.at(U("admin_user")).as_string();
-    std::string bhr_org = org_val.at(U("bamboohr_org")).as_string();
-    std::string bhr_secret = org_val.at(U("bamboohr_secret")).as_string();
-    std::string slack_token = org_val.at(U("token")).at(U("access_token")).as_string();
+  /// @brief Pending users.profile.set request
+  struct Update {
+    std::string slack_id;
+    pplx::task<void> task;
+    std::function<void()> on_success;
+  };
+
+  const std::string slack_team_id;
+  const std::size_t size;
+  std::deque<Update> pending;
+};
+
+std::string RenderWioResponse(const std::string& message) {
+  // Builds a response with text message to say who is out today
+  web::json::value response;
+  response[U("text")] = web::json::value::string(message != "" ? message : "Nothing found.");
 
-    SlackApiClient slack_api_client(slack_token);
-    BambooHrApiClient bamboohr_api_client(bhr_secret, bhr_org);
+  return response.serialize();
+}
+
+void SyncTeam(const Org& org, DB::Batch* batch) {
+  const std::string& slack_team_id = org.slack_team_id;
+  const std::string& slack_admin_user_id = org.admin_user;
+
+  SlackApiClient slack_api_client(org.admin_token);
+  BambooHrApiClient bamboohr_api_client(org.bamboohr_secret, org.bamboohr_org);
+  // Who is out data for the team
+  std::vector<std::string> wio_data;
+  // Slack users who exist in the bambooHR with their last applied statuses
+  SlackUsersList slack_users;
+  // When the statuses were fetched from Slack last time
+  uint64_t reconciled_at = 0;
+  const uint64_t now = std::time(nullptr);
+
+  // Statuses are compared against the stored snapshot, and they are fetched from Slack only periodically
+  // in order to catch new employees and statuses that have been changed manually.
+  if (!DB::GetInstance().GetStatusSnapshot(slack_team_id, &slack_users, &reconciled_at)
+      || now - reconciled_at >= app_config.kFullSyncInterval
+  ) {
+    LOG(INFO) << "Full reconciliation of " << slack_team_id << "...";
     // Prefetch all bambooHR active employees
     BambooHrUsersList bamboohr_users = bamboohr_api_client.UsersList();
-    // Who is out data for the team
-    std::vector<std::string> wio_data;
     // Gets all users from Slack who exist in the bambooHR
-    SlackUsersList slack_users = slack_api_client.UsersList(bamboohr_users);
-
-    // Get time offs schedule between yesterday and tomorrow
-    BambooHrTimeOffList timeoff_list = bamboohr_api_client.WhoIsOut(
-        GetCurrentTimestamp("%Y-%m-%d", -90000),
-        GetCurrentTimestamp("%Y-%m-%d", 90000)
-    );
-
-    LOG(INFO) << "Who is out today?";
-
-    for (const auto& [user_email, user] : slack_users) {
-      // Is there time-off for the current employee?
-      auto iter = timeoff_list.find(user.bamboohr_employee_id);
-      if (iter == timeoff_list.end()) {
-        // time off does not exist
-        continue;
-      }
+    slack_users = slack_api_client.UsersList(bamboohr_users);
+    reconciled_at = now;
+  }
 
-      // Get user's date in her timezone. If user is working in america her date can be different from the Europe.
-      auto user_cur_date = GetCurrentTimestamp("%Y-%m-%d", user.tz_offset);
+  // Get time offs schedule between yesterday and tomorrow
+  BambooHrTimeOffList timeoff_list = bamboohr_api_client.WhoIsOut(
+      GetCurrentTimestamp("%Y-%m-%d", -90000),
+      GetCurrentTimestamp("%Y-%m-%d", 90000)
+  );
 
-      auto it = iter->second.find(user_cur_date);
-      if (it == std::end(iter->second)) {
-        // time off for the current date does not exist
-        continue;
-      }
+  LOG(INFO) << "Who is out today in " << slack_team_id << "?";
 
-      // If user has more than one time off type for the selected day it chooses an appropriate one based on priorities.
-      // Then less int value of type then more priority.
-      if (it->second.size() > 1) {
-        sort(it->second.begin(), it->second.end());
-      }
+  // Pending users.profile.set requests
+  StatusUpdateWindow in_flight(slack_team_id, app_config.kStatusUpdateConcurrency);
 
-      // The name of the accepted time-off type
-      std::string time_off_type = it->second.front();
-      // user's time off profile to apply
-      TimeOffProfile time_off_profile_to_apply;
-
-      auto time_off_iter = TimeOff::NAMES.find(time_off_type);
-      if (time_off_iter == TimeOff::NAMES.end()) {
-        // Unknown type
-        time_off_profile_to_apply = {
-            time_off_type,
-            U(":grey_question:"),
-            time_off_type
-        };
-      } else {
-        time_off_profile_to_apply = TimeOff::TYPES.at(time_off_iter->second);
-      }
+  for (auto& user : slack_users) {
+    // Get user's date in her timezone. If user is working in america her date can be different from the Europe.
+    const int32_t user_cur_day = GetCurrentDay(user.tz_offset);
 
-      // offset should be subtracted from the timestamp in UTC TZ as to be just in time in the user's TZ
-      auto expected_status_expiration = strtotime(user_cur_date + " 23:59:59") - user.tz_offset;
-
-      // Creating "who is out" record for this user
-      std::stringstream line;
-      line << "<@" << user.slack_id << "> (" << user.real_name << ") "
-           << time_off_profile_to_apply.text << " " << time_off_profile_to_apply.emoji;
-
-      wio_data.push_back(line.str());
-
-      // Should we change anything?
-      if (user.status_emoji == time_off_profile_to_apply.emoji &&
-          user.status_expiration == expected_status_expiration) {
-        LOG(INFO) << "Skipping. " << user.real_name << " has actual status"
-                  << " - slackId: " << user.slack_id
-                  << " - employeeId: " << user.bamboohr_employee_id
-                  << " - tz_off: " << user.tz_offset
-                  << " - emoji: " << time_off_profile_to_apply.emoji
-                  << " - exp: " << "'" << user_cur_date << "' " << expected_status_expiration
-                  << " - old (status: " << user.status_text
-                  << ", emoji: " << user.status_emoji
-                  << ", exp: " << user.status_expiration << ")";
-        continue;
-      }
+    // Is there time-off for the current employee and date?
+    // If user has more than one time off type for the selected day it chooses the first one by name.
+    const std::string* time_off_type = timeoff_list.FindType(user.bamboohr_employee_id, user_cur_day);
+    if (time_off_type == nullptr) {
+      // time off does not exist
+      continue;
+    }
+
+    auto user_cur_date = GetCurrentTimestamp("%Y-%m-%d", user.tz_offset);
+
+    // user's time off profile to apply
+    TimeOffProfile time_off_profile_to_apply;
+
+    auto time_off_iter = TimeOff::NAMES.find(*time_off_type);
+    if (time_off_iter == TimeOff::NAMES.end()) {
+      // Unknown type
+      time_off_profile_to_apply = {
+          *time_off_type,
+          U(":grey_question:"),
+          *time_off_type
+      };
+    } else {
+      time_off_profile_to_apply = TimeOff::TYPES.at(time_off_iter->second);
+    }
+
+    // offset should be subtracted from the timestamp in UTC TZ as to be just in time in the user's TZ
+    const uint64_t expected_status_expiration = (user_cur_day + 1) * 86400L - 1 - user.tz_offset;
 
-      LOG(INFO) << "Setting '" << time_off_profile_to_apply.text << "' status for " << user.real_name
+    // Creating "who is out" record for this user
+    std::stringstream line;
+    line << "<@" << user.slack_id << "> (" << user.real_name << ") "
+         << time_off_profile_to_apply.text << " " << time_off_profile_to_apply.emoji;
+
+    wio_data.push_back(line.str());
+
+    // Should we change anything?
+    if (user.status_emoji == time_off_profile_to_apply.emoji &&
+        user.status_expiration == expected_status_expiration) {
+      LOG(INFO) << "Skipping. " << user.real_name << " has actual status"
                 << " - slackId: " << user.slack_id
                 << " - employeeId: " << user.bamboohr_employee_id
                 << " - tz_off: " << user.tz_offset
@@ -198,38 +406,184 @@ void SyncUserProfileStatuses() {
                 << " - old (status: " << user.status_text
                 << ", emoji: " << user.status_emoji
                 << ", exp: " << user.status_expiration << ")";
+      continue;
+    }
 
-      if (user.is_privileged && user.slack_id != slack_admin_user_id) {
-        //If user is admin we should try to use his own token if it exists
-        web::json::value atoken;
-        if (DB::GetInstance().GetUserToken(slack_team_id, user.slack_id, &atoken)) {
-          // Token has been found. Updating user's profile status
-          SlackApiClient aclient(atoken[U("access_token")].as_string());
-          aclient.UsersProfileSetStatus(
-              user.slack_id,
-              time_off_profile_to_apply,
-              expected_status_expiration
-          );
-        }
-      } else {
-        // Sets user's status in Slack
-        slack_api_client.UsersProfileSetStatus(
+    LOG(INFO) << "Setting '" << time_off_profile_to_apply.text << "' status for " << user.real_name
+              << " - slackId: " << user.slack_id
+              << " - employeeId: " << user.bamboohr_employee_id
+              << " - tz_off: " << user.tz_offset
+              << " - emoji: " << time_off_profile_to_apply.emoji
+              << " - exp: " << "'" << user_cur_date << "' " << expected_status_expiration
+              << " - old (status: " << user.status_text
+              << ", emoji: " << user.status_emoji
+              << ", exp: " << user.status_expiration << ")";
+
+    // Remembers the status once Slack has accepted it
+    auto applied = [&user, time_off_profile_to_apply, expected_status_expiration]() {
+      user.status_text = time_off_profile_to_apply.text;
+      user.status_emoji = time_off_profile_to_apply.emoji;
+      user.status_text_canonical = time_off_profile_to_apply.text_canonical;
+      user.status_expiration = expected_status_expiration;
+    };
+
+    if (user.is_privileged && user.slack_id != slack_admin_user_id) {
+      //If user is admin we should try to use his own token if it exists
+      std::string atoken;
+      if (DB::GetInstance().GetAccessToken(slack_team_id, user.slack_id, &atoken)) {
+        // Token has been found. Updating user's profile status
+        SlackApiClient aclient(atoken);
+        in_flight.Push(
             user.slack_id,
-            time_off_profile_to_apply,
-            expected_status_expiration
+            aclient.UsersProfileSetStatusAsync(
+                user.slack_id,
+                time_off_profile_to_apply,
+                expected_status_expiration
+            ),
+            applied
         );
       }
+    } else {
+      // Sets user's status in Slack
+      in_flight.Push(
+          user.slack_id,
+          slack_api_client.UsersProfileSetStatusAsync(
+              user.slack_id,
+              time_off_profile_to_apply,
+              expected_status_expiration
+          ),
+          applied
+      );
     }
+  }
 
-    if (wio_data.empty()) {
-      LOG(INFO) << "No time offs found.";
-      wio_data.push_back("Everybody is on board.");
-    }
+  // Waits for the rest of the status updates
+  in_flight.Drain();
+
+  batch->PutStatusSnapshot(slack_team_id, slack_users, reconciled_at);
+
+  if (wio_data.empty()) {
+    LOG(INFO) << "No time offs found in " << slack_team_id << ".";
+    wio_data.push_back("Everybody is on board.");
+  }
+
+  // Who is out response is rendered once here and committed to database along with the other teams
+  batch->PutWioResponse(slack_team_id, RenderWioResponse(boost::algorithm::join(wio_data, "\n")));
+}
 
-    //Put who is out data to database
-    if (!DB::GetInstance().PutWioData(slack_team_id, boost::algorithm::join(wio_data, "\n"))) {
-      LOG(ERROR) << "Unable to store who-is-out information to database.";
+void SyncUserProfileStatuses() {
+  // Teams are handed out to the workers in the order of their IDs
+  std::vector<Org> queue;
+
+  if (!DB::GetInstance().GetOrgs(&queue)) {
+    LOG(ERROR) << "Could not retrieve a list of organizations from database";
+    return;
+  }
+
+  if (queue.empty()) {
+    return;
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  std::atomic<std::size_t> next {0};
+  std::atomic<std::size_t> failed {0};
+  // Results of all teams are committed at once when the pass is over
+  DB::Batch batch {DB::GetInstance()};
+
+  auto worker = [&queue, &next, &failed, &batch]() {
+    for (std::size_t i = next++; i < queue.size(); i = next++) {
+      const Org& org = queue[i];
+      const std::string& slack_team_id = org.slack_team_id;
+
+      // A failure of one team must not abort synchronization of the others
+      try {
+        SyncTeam(org, &batch);
+      } catch (web::http::http_exception& e) {
+        ++failed;
+        LOG(ERROR) << "Sync: " << slack_team_id << ": HTTP Error: " << e.what();
+      } catch (std::runtime_error& e) {
+        ++failed;
+        LOG(ERROR) << "Sync: " << slack_team_id << ": Runtime Error: " << e.what();
+      } catch (std::exception& e) {
+        ++failed;
+        LOG(ERROR) << "Sync: " << slack_team_id << ": Fatal Error: " << e.what();
+      }
     }
+  };
+
+  const std::size_t pool_size = std::min<std::size_t>(app_config.kSyncConcurrency, queue.size());
+  std::vector<std::thread> pool;
+  pool.reserve(pool_size);
+
+  for (std::size_t i = 0; i < pool_size; ++i) {
+    pool.emplace_back(worker);
+  }
+
+  for (auto& t : pool) {
+    t.join();
+  }
+
+  const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - started
+  ).count();
+
+  LOG(INFO) << "Sync: " << queue.size() - failed << " of " << queue.size() << " teams synchronized"
+            << " using " << pool_size << " workers in " << elapsed_ms << "ms.";
+
+  web::json::value stats;
+  stats[U("time")] = web::json::value::number(static_cast<uint64_t>(std::time(nullptr)));
+  stats[U("teams")] = web::json::value::number(static_cast<uint64_t>(queue.size()));
+  stats[U("failed")] = web::json::value::number(static_cast<uint64_t>(failed));
+  stats[U("workers")] = web::json::value::number(static_cast<uint64_t>(pool_size));
+  stats[U("duration_ms")] = web::json::value::number(static_cast<int64_t>(elapsed_ms));
+  batch.PutSyncStats(stats);
+
+  const std::size_t records = batch.size();
+  if (!DB::GetInstance().Write(&batch)) {
+    LOG(ERROR) << "Sync: unable to store " << records << " records to database.";
+  }
+
+  const auto http = HttpClientPool::GetInstance().GetStats();
+  LOG(INFO) << "HTTP client pool: requests: " << http.requests
+            << " - reused: " << http.reused
+            << " - clients created: " << http.created
+            << " - failed: " << http.failed
+            << " - avg latency: " << (http.requests > 0 ? http.latency_us / http.requests : 0) << "us";
+
+  const auto limits = SlackRateLimiter::GetInstance().GetStats();
+  LOG(INFO) << "Slack rate limiter: delayed: " << limits.delayed
+            << " - delay: " << limits.delay_ms << "ms"
+            << " - throttled: " << limits.throttled
+            << " - retried: " << limits.retried
+            << " - dropped: " << limits.dropped;
+
+  const auto cache = ResponseCache::GetInstance().GetStats();
+  LOG(INFO) << "BambooHR response cache: hits: " << cache.hits
+            << " - revalidated: " << cache.revalidated
+            << " - misses: " << cache.misses;
+
+  const auto wio = DB::GetInstance().GetWioCacheStats();
+  LOG(INFO) << "Who-is-out cache: hits: " << wio.hits
+            << " - misses: " << wio.misses;
+  LOG(INFO) << "Legacy encrypted records migrated: " << DB::GetInstance().GetMigratedRecords();
+}
+
+void ReapInstallCallbacks() {
+  const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+  const auto started = std::chrono::steady_clock::now();
+
+  uint64_t expired = 0;
+  if (!DB::GetInstance().ExpireInstallCallbacks(now - app_config.kInstallCallbackTTL, &expired)) {
+    LOG(ERROR) << "Install callbacks: could not delete expired callbacks";
+    return;
+  }
+
+  if (expired > 0) {
+    const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started
+    ).count();
+    LOG(INFO) << "Install callbacks: " << expired << " expired callbacks deleted in " << elapsed_ms << "ms"
+              << " - total: " << DB::GetInstance().GetExpiredCallbacks();
   }
 }
 } //namespace bs
\ No newline at end of file
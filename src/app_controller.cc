@@ -1,9 +1,15 @@
-#include <regex>
+#include <optional>
+#include <string_view>
 #include <cpprest/filestream.h>
 #include <bamboohrapi.h>
 #include "common.h"
 #include "encryption.h"
+#include "app.h"
 #include "db.h"
+#include "http_client_pool.h"
+#include "rate_limiter.h"
+#include "response_cache.h"
+#include "signature_verifier.h"
 #include "uri.h"
 #include "slackapi.h"
 #include "easylogging++.h"
@@ -30,13 +36,17 @@ pplx::task<concurrency::streams::streambuf<_CharType>> OPEN_R(const std::string&
   return concurrency::streams::file_buffer<_CharType>::open(kTemplatesDIR + file, std::ios_base::in);
 }
 
+/// @brief The host of Slack command Response URLs
+static const std::string kSlackHooksUrl {"https://hooks.slack.com"};
+
 /// @brief Create a reply for a Slack command request
 /// @param url Slack command Response URL
 /// @param message Reply message
 static void PostToResponseURL(const std::string& url, const std::string& message) {
-  client::http_client client(url);
+  const web::uri response_uri {url};
   http_request req(methods::POST);
 
+  req.set_request_uri(response_uri.resource());
   req.headers().add(U("Content-Type"), U("application/json; charset=utf-8"));
 
   if (!message.empty() && message[0] != '{') {
@@ -47,7 +57,14 @@ static void PostToResponseURL(const std::string& url, const std::string& message
     req.set_body(message);
   }
 
-  http_response response = client.request(req).get();
+  // The URL comes from the request, so only the Slack host gets a pooled client. Any other host is sent
+  // through a short-lived client, which keeps the pool from growing with hosts that are never used again.
+  http_response response;
+  if (response_uri.authority() == web::uri(kSlackHooksUrl).authority()) {
+    response = HttpClientPool::GetInstance().Request(url, req).get();
+  } else {
+    response = client::http_client(response_uri.authority()).request(req).get();
+  }
 
   if (response.status_code() != 200) {
     throw std::runtime_error("Unable to POST to response URL: " + response.to_string());
@@ -81,13 +98,14 @@ static bool ProcessInstallCommand(
 
     if (request_token) {
       // Store secret to database to proceed right after redirect
-      json::value d;
       // Team ID and User ID should come with redirect request
-      d[U("response_url")] = json::value::string(response_url);
-      d[U("admin_user")] = json::value::string(user_id);
-      d[U("bamboohr_org")] = json::value::string(bamboo_hr_org);
-      d[U("bamboohr_secret")] = json::value::string(bamboo_hr_secret);
-      d[U("time")] = json::value::number(system_clock::to_time_t(system_clock::now()));
+      const InstallCallback d {
+          response_url,
+          user_id,
+          bamboo_hr_org,
+          bamboo_hr_secret,
+          system_clock::to_time_t(system_clock::now())
+      };
 
       if (!DB::GetInstance().PutInstallCallback(trigger_id, d)) {
         LOG(ERROR) << "Could not store install callback to database:";
@@ -131,15 +149,15 @@ static bool ProcessInstallCommand(
 
   LOG(DEBUG) << "Install: Checking if user_token exists in DB...";
   // Verify if user's token does already exist in the database
-  json::value user_token;
-  if (!DB::GetInstance().GetUserToken(team_id, user_id, &user_token)) {
+  std::string user_token;
+  if (!DB::GetInstance().GetAccessToken(team_id, user_id, &user_token)) {
     // There is no token for this user
     return ReqToken("Token does not exist.");
   }
 
   // Using token to check whether this user is privileged user
   json::value user_info;
-  SlackApiClient api_client {user_token[U("access_token")].as_string()};
+  SlackApiClient api_client {user_token};
 
   LOG(DEBUG) << "Install: Checking Slack token scopes by requesting api.test endpoint...";
 
@@ -270,10 +288,17 @@ static bool ProcessInstallCommand(
 /// @param message A HTTP request message
 static void HandleSlackRedirect(http_request& message) {
   // OAuth2 redirect when user allows application permissions
-  auto params = uri::split_query(message.request_uri().query());
-  auto code = params.count(U("code")) ? url_decode(params[U("code")]) : "";
-  auto state = params.count(U("state")) ? url_decode(params[U("state")]) : "";
-  auto error = params.count(U("error")) ? url_decode(params[U("error")]) : "";
+  std::string code, state, error;
+  try {
+    FormData params {std::string(message.request_uri().query())};
+    code = params.Get("code");
+    state = params.Get("state");
+    error = params.Get("error");
+  } catch (web::uri_exception& e) {
+    message.reply(status_codes::BadRequest, "Invalid query string.");
+
+    return;
+  }
 
   // We must sanitize key as it's used as a part of the key of a database record
   boost::trim_if(state, boost::is_cntrl() || boost::is_space());
@@ -310,10 +335,15 @@ static void HandleSlackRedirect(http_request& message) {
       && !value.at(U("access_token")).is_null()
   ) {
     //Token received successfully. Storing to database.
+    // Only the fields the application needs are kept from oauth.access response
+    const UserToken token {
+        value[U("access_token")].as_string(),
+        value.has_field(U("scope")) && value.at(U("scope")).is_string() ? value.at(U("scope")).as_string() : ""
+    };
     if (!DB::GetInstance().PutUserToken(
         value[U("team_id")].as_string(),
         value[U("user_id")].as_string(),
-        value
+        token
     )) {
       http_response response(status_codes::TemporaryRedirect);
       response.headers().add(U("Location"), U("/?error=db_error"));
@@ -343,19 +373,19 @@ static void HandleSlackRedirect(http_request& message) {
   if (state != "") {
     LOG(DEBUG) << "Redirect request: Trying to finish install request...";
     // Trying to get callback data
-    json::value cb_data;
+    InstallCallback cb_data;
     if (DB::GetInstance().GetInstallCallback(state, &cb_data)) {
       LOG(DEBUG) << "Redirect request: Callback found. Processing Install command again...";
 
       try {
         // It does exist so we have to finish install workflow by invoking action again
         ProcessInstallCommand(
-            cb_data[U("response_url")].as_string(),
+            cb_data.response_url,
             state,
             value[U("team_id")].as_string(),
             value[U("user_id")].as_string(),
-            cb_data[U("bamboohr_org")].as_string(),
-            cb_data[U("bamboohr_secret")].as_string(),
+            cb_data.bamboohr_org,
+            cb_data.bamboohr_secret,
             false
         );
       } catch (std::exception& e) {
@@ -385,45 +415,45 @@ static void HandleSlashCommandRequest(http_request& message) {
     return;
   }
 
-  // Gets current timestamp
-  std::time_t tt = system_clock::to_time_t(system_clock::now());
-  long int t = 0;
-  try {
-    t = std::stoi(ts_iter->second);
-  } catch (...) {
-    message.reply(status_codes::BadRequest, "Invalid timestamp.");
+  // Validates signature
+  const std::time_t now = system_clock::to_time_t(system_clock::now());
+  switch (SignatureVerifier::GetInstance().Verify(ts_iter->second, payload, sig_iter->second, now)) {
+    case SignatureVerifier::STALE:
+      message.reply(status_codes::Forbidden, "Stale timestamp.");
 
-    return;
-  }
-  // Checks if the timestamp is not stale
-  if (std::abs(tt - t) > 1000) {
-    message.reply(
-        status_codes::Forbidden,
-        "Clock skew: " + std::to_string(std::abs(tt - t)) + "."
-    );
+      return;
+    case SignatureVerifier::MISMATCH:
+      message.reply(status_codes::Forbidden, "Signature does not match.");
 
-    return;
-  }
-  // Validates signature
-  auto hash {"v0=" + hmac_sha256("v0:" + ts_iter->second + ":" + payload, app_config.kSlackSigningSecret)};
-  if (hash != sig_iter->second) {
-    message.reply(status_codes::Forbidden, "Signature does not match.");
+      return;
+    case SignatureVerifier::REPLAYED:
+      LOG(DEBUG) << "Duplicate delivery of the command request has been rejected.";
+      message.reply(status_codes::Forbidden, "Duplicate request.");
 
-    return;
+      return;
+    default:
+      break;
   }
 
-  // Retrieves payload options
-  auto params = uri::split_query(payload);
-
   LOG(DEBUG) << "Payload: " << payload;
 
-  // Parsing command options
-  const std::string team_id {!params.at("team_id").empty() ? url_decode(params["team_id"]) : ""};
-  const std::string user_id {!params.at("user_id").empty() ? url_decode(params["user_id"]) : ""};
-  const std::string trigger_id {!params.at("trigger_id").empty() ? url_decode(params["trigger_id"]) : ""};
-  const std::string response_url {!params.at("response_url").empty() ? url_decode(params["response_url"]) : ""};
+  // Retrieves payload options. The form is decoded in place, so the payload is moved into it.
+  std::optional<FormData> params;
+  try {
+    params.emplace(std::move(payload));
+  } catch (web::uri_exception& e) {
+    message.reply(status_codes::BadRequest, "Invalid payload encoding.");
+
+    return;
+  }
+
+  // Parsing command options. The views point into the form, so they are validated without copying.
+  const std::string_view team_id {params->Get("team_id")};
+  const std::string_view user_id {params->Get("user_id")};
+  const std::string_view trigger_id {params->Get("trigger_id")};
+  const std::string_view response_url {params->Get("response_url")};
 
-  if (!std::regex_match(team_id, kRegexAlphanum) || !std::regex_match(user_id, kRegexAlphanum)) {
+  if (!IsAlphanum(team_id) || !IsAlphanum(user_id)) {
     message.reply(
         status_codes::BadRequest,
         "Invalid payload: team_id and user_id must be nonempty alphanumeric strings."
@@ -432,7 +462,7 @@ static void HandleSlashCommandRequest(http_request& message) {
     return;
   }
   // Validating trigger identifier
-  if (!std::regex_match(trigger_id, std::regex("[a-z0-9_\\.]+", std::regex::icase))) {
+  if (!IsTriggerId(trigger_id)) {
     message.reply(
         status_codes::BadRequest,
         "Invalid payload: trigger_id must be nonempty alphanumeric strings."
@@ -441,7 +471,7 @@ static void HandleSlashCommandRequest(http_request& message) {
     return;
   }
 
-  if (!std::regex_match(response_url, std::regex("^https://.+"))) {
+  if (!IsHttpsUrl(response_url)) {
     message.reply(
         status_codes::BadRequest,
         "Invalid response URL."
@@ -452,7 +482,7 @@ static void HandleSlashCommandRequest(http_request& message) {
 
   // At this point request is considered to be valid
 
-  std::string input {params.at("text").empty() ? "" : url_decode(params["text"])};
+  std::string input {params->Get("text")};
   // Removing trailing spaces
   boost::trim_if(input, boost::is_cntrl() || boost::is_space());
   std::vector<std::string> tokens;
@@ -464,8 +494,8 @@ static void HandleSlashCommandRequest(http_request& message) {
       LOG(DEBUG) << "Starting install command...";
       // install command
       if (tokens.size() != 3
-          || !std::regex_match(tokens[1], kRegexWord)
-          || !std::regex_match(tokens[2], std::regex("[a-f0-9]{40,}", std::regex::icase))
+          || !IsWord(tokens[1])
+          || !IsHexString(tokens[2], 40)
       ) {
         message.reply(status_codes::OK, kCommandUsage);
 
@@ -477,17 +507,17 @@ static void HandleSlashCommandRequest(http_request& message) {
 
       try {
         ProcessInstallCommand(
-            response_url,
-            trigger_id,
-            team_id,
-            user_id,
+            std::string(response_url),
+            std::string(trigger_id),
+            std::string(team_id),
+            std::string(user_id),
             tokens[1],
             tokens[2],
             true
         );
       } catch (std::exception& e) {
         LOG(ERROR) << "Unable to process install command: " << e.what();
-        PostToResponseURL(response_url, "Sorry, internal error occurred. Please try again later.");
+        PostToResponseURL(std::string(response_url), "Sorry, internal error occurred. Please try again later.");
 
         return;
       }
@@ -503,14 +533,93 @@ static void HandleSlashCommandRequest(http_request& message) {
 
   LOG(DEBUG) << "Responding to " << kCommandName << " command...";
 
-  // Gets who is out data for the requested Slack Team ID
-  std::string wio_data = DB::GetInstance().GetWioData(team_id);
+  // Gets who is out response for the requested Slack Team ID. It is rendered by the sync, so it is sent as is.
+  std::string response;
+  if (!DB::GetInstance().GetWioResponse(std::string(team_id), &response)) {
+    LOG(ERROR) << "Unable to read who is out response of " << std::string(team_id);
+    message.reply(status_codes::OK, RenderWioResponse("Sorry, internal error occurred. Please try again later."),
+                  U("application/json; charset=utf-8"));
+
+    return;
+  }
+  if (response.empty()) {
+    response = RenderWioResponse("");
+  }
+  message.reply(status_codes::OK, response, U("application/json; charset=utf-8"));
+}
 
-  // Builds a response with text message to say who is out today
-  json::value response;
-  response["text"] = json::value::string(wio_data != "" ? wio_data : "Nothing found.");
+/// @brief Handle service status request. It's answered to the local clients only.
+/// @param message A HTTP request message
+static void HandleStatusRequest(http_request& message) {
+  const std::string address {message.remote_address()};
+  if (address != "127.0.0.1" && address != "::1" && address != "::ffff:127.0.0.1") {
+    message.reply(status_codes::Forbidden);
+
+    return;
+  }
+
+  auto& db = DB::GetInstance();
+  json::value status;
+  status[U("version")] = json::value::string(Version());
+
+  // The storage figures let the block cache and the write buffer be sized for the actual number of keys
+  json::value storage;
+  storage[U("backend")] = json::value::string(app_config.kDbBackend);
+  std::string property;
+  if (db.GetStorageProperty(kStoragePropertyStats, &property)) {
+    storage[U("stats")] = json::value::string(property);
+  }
+  if (db.GetStorageProperty(kStoragePropertyMemoryUsage, &property)) {
+    storage[U("approximate_memory_usage")] = json::value::number(static_cast<uint64_t>(std::stoull(property)));
+  }
+  if (db.GetStorageProperty(kStoragePropertyBlockCacheUsage, &property)) {
+    storage[U("block_cache_usage")] = json::value::number(static_cast<uint64_t>(std::stoull(property)));
+  }
+  storage[U("block_cache_size")] = json::value::number(app_config.kDbBlockCacheSize);
+  storage[U("write_buffer_size")] = json::value::number(app_config.kDbWriteBufferSize);
+  storage[U("migrated_records")] = json::value::number(db.GetMigratedRecords());
+  storage[U("expired_callbacks")] = json::value::number(db.GetExpiredCallbacks());
+  status[U("storage")] = std::move(storage);
+
+  const auto http = HttpClientPool::GetInstance().GetStats();
+  json::value pool;
+  pool[U("requests")] = json::value::number(http.requests);
+  pool[U("reused")] = json::value::number(http.reused);
+  pool[U("created")] = json::value::number(http.created);
+  pool[U("failed")] = json::value::number(http.failed);
+  pool[U("latency_us")] = json::value::number(http.latency_us);
+  status[U("http_client_pool")] = std::move(pool);
+
+  const auto limits = SlackRateLimiter::GetInstance().GetStats();
+  json::value limiter;
+  limiter[U("delayed")] = json::value::number(limits.delayed);
+  limiter[U("delay_ms")] = json::value::number(limits.delay_ms);
+  limiter[U("throttled")] = json::value::number(limits.throttled);
+  limiter[U("retried")] = json::value::number(limits.retried);
+  limiter[U("dropped")] = json::value::number(limits.dropped);
+  status[U("slack_rate_limiter")] = std::move(limiter);
+
+  const auto responses = ResponseCache::GetInstance().GetStats();
+  json::value cache;
+  cache[U("hits")] = json::value::number(responses.hits);
+  cache[U("revalidated")] = json::value::number(responses.revalidated);
+  cache[U("misses")] = json::value::number(responses.misses);
+  status[U("bamboohr_response_cache")] = std::move(cache);
+
+  const auto wio = db.GetWioCacheStats();
+  json::value wio_cache;
+  wio_cache[U("hits")] = json::value::number(wio.hits);
+  wio_cache[U("misses")] = json::value::number(wio.misses);
+  status[U("wio_cache")] = std::move(wio_cache);
+
+  status[U("replayed_requests")] = json::value::number(SignatureVerifier::GetInstance().Replayed());
+
+  json::value sync;
+  if (db.GetSyncStats(&sync)) {
+    status[U("sync")] = std::move(sync);
+  }
 
-  message.reply(status_codes::OK, response);
+  message.reply(status_codes::OK, status);
 }
 
 void AppController::HandleGet(http_request message) {
@@ -521,6 +630,8 @@ void AppController::HandleGet(http_request message) {
     message.reply(status_codes::OK, str, kContentTypeTextHTMLCharsetUTF8);
   } else if (path[0] == "redirect") {
     HandleSlackRedirect(message);
+  } else if (path[0] == "status") {
+    HandleStatusRequest(message);
   } else if (path[0] == "interactive" || path[0] == "command") {
     http_response response(status_codes::MethodNotAllowed);
     response.headers().add(U("Allow"), U("POST"));
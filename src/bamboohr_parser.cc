@@ -0,0 +1,42 @@
+#include "bamboohr_parser.h"
+
+using namespace web;
+
+namespace bs {
+BambooHrUsersList ParseUsersList(const json::value& response) {
+  BambooHrUsersList users;
+  const auto& object = response.as_object();
+
+  for (auto i = object.begin(); i != object.end(); i++) {
+    // Ignoring fired employees
+    if (U("enabled") != i->second.at(U("status")).as_string())
+      continue;
+
+    users[i->second.at(U("email")).as_string()] = i->second.at(U("employeeId")).as_integer();
+  }
+
+  return users;
+}
+
+BambooHrTimeOffList ParseTimeOffRequests(const json::value& response, int32_t start_day, int32_t end_day) {
+  BambooHrTimeOffList ret;
+  const auto& array = response.as_array();
+
+  for (std::size_t i = 0; i < array.size(); ++i) {
+    const auto employee_id = std::stoi(array[i].at(U("employeeId")).as_string());
+    const auto& timeoff_type = array[i].at(U("type")).at(U("name")).as_string();
+    const auto& dates = array[i].at(U("dates")).as_object();
+    // Pick only dates where time off is active in the specified period
+    for (auto v = std::begin(dates); v != std::end(dates); v++) {
+      const int32_t day = strtodays(v->first);
+      if (start_day <= day && day <= end_day) {
+        ret.Add(employee_id, day, timeoff_type);
+      }
+    }
+  }
+
+  ret.Sort();
+
+  return ret;
+}
+} // namespace bs
@@ -1,4 +1,9 @@
+#include <ctime>
+#include "bamboohr_parser.h"
 #include "base64.h"
+#include "encryption.h"
+#include "http_client_pool.h"
+#include "response_cache.h"
 #include "bamboohrapi.h"
 
 using namespace web;
@@ -6,52 +11,85 @@ using namespace web::http;
 
 namespace bs {
 BambooHrApiClient::BambooHrApiClient(const std::string& kApiToken, const std::string& kOrgName)
-    : kApiToken(kApiToken), kOrgName(kOrgName) {}
+    : kApiToken(kApiToken),
+      kOrgName(kOrgName),
+      kAuthorization("Basic " + base64_encode(kApiToken + ":x")) {}
+
+std::shared_ptr<const json::value> BambooHrApiClient::SendRequest(const method& mtd, const std::string& uri) {
+  auto& cache = ResponseCache::GetInstance();
+  const uint64_t now = std::time(nullptr);
+  // Keeps one entry per endpoint and token. The token is only used as a HMAC key so it is not exposed.
+  const std::string cache_key = hmac_sha256(kApiUrl + uri.substr(0, uri.find('?')), kApiToken);
+  ResponseCache::Entry entry;
+  const bool cached = mtd == methods::GET && cache.Get(cache_key, uri, &entry);
+
+  if (cached && now - entry.fetched_at < app_config.kBambooHrCacheTTL) {
+    cache.Hit();
+
+    return entry.body;
+  }
 
-json::value BambooHrApiClient::SendRequest(const method& mtd, const std::string& uri) {
-  client::http_client client(kApiUrl);
   http_request req(mtd);
 
   req.headers().add(U("Accept"), U("application/json"));
   req.headers().add(U("User-Agent"), GetUserAgent());
   req.headers().add(U("Accept-Charset"), U("utf-8"));
   // BambooHR API uses basic authentication
-  req.headers().add(U("Authorization"), U("Basic " + base64_encode(kApiToken + ":x")));
+  req.headers().add(U("Authorization"), kAuthorization);
   req.set_request_uri(uri);
 
-  http_response response = client.request(req).get();
+  // Asks the server to confirm that the cached response is still valid
+  if (cached && entry.etag != "") {
+    req.headers().add(U("If-None-Match"), entry.etag);
+  }
+  if (cached && entry.last_modified != "") {
+    req.headers().add(U("If-Modified-Since"), entry.last_modified);
+  }
+
+  http_response response = HttpClientPool::GetInstance().Request(kApiUrl, req).get();
+
+  if (cached && response.status_code() == status_codes::NotModified) {
+    cache.Revalidated();
+    entry.fetched_at = now;
+    cache.Put(cache_key, entry);
+
+    return entry.body;
+  }
 
   if (response.status_code() != 200) {
     throw BambooHrApiError(response.status_code());
   }
 
-  return response.extract_json().get();
-}
+  auto result = std::make_shared<const json::value>(response.extract_json().get());
 
-BambooHrUsersList BambooHrApiClient::UsersList() {
-  BambooHrUsersList users;
+  if (mtd == methods::GET) {
+    cache.Miss();
 
-  // Build request URI and start the request.
-  uri_builder builder(U("/api/gateway.php/" + kOrgName + "/v1/meta/users/"));
+    const auto& headers = response.headers();
+    const auto etag = headers.find(U("ETag"));
+    const auto last_modified = headers.find(U("Last-Modified"));
 
-  json::value json_response = SendRequest(methods::GET, builder.to_string());
-
-  auto object = json_response.as_object();
+    cache.Put(cache_key, {
+        uri,
+        result,
+        etag != headers.end() ? etag->second : "",
+        last_modified != headers.end() ? last_modified->second : "",
+        now
+    });
+  }
 
-  for (auto i = object.begin(); i != object.end(); i++) {
-    // Ignoring fired employees
-    if (U("enabled") != i->second.at(U("status")).as_string())
-      continue;
+  return result;
+}
 
-    users[i->second.at(U("email")).as_string()] = i->second.at(U("employeeId")).as_integer();
-  }
+BambooHrUsersList BambooHrApiClient::UsersList() {
+  // Build request URI and start the request.
+  uri_builder builder(U("/api/gateway.php/" + kOrgName + "/v1/meta/users/"));
 
-  return users;
+  // The response is shared with the cache, so it is only read by reference
+  return ParseUsersList(*SendRequest(methods::GET, builder.to_string()));
 }
 
 BambooHrTimeOffList BambooHrApiClient::WhoIsOut(const std::string& start_date, const std::string& end_date) {
-  BambooHrTimeOffList ret;
-
   if (start_date == "" || end_date == "") {
     throw std::invalid_argument("date should be nonempty and provided in the Y-m-d format.");
   }
@@ -66,40 +104,11 @@ BambooHrTimeOffList BambooHrApiClient::WhoIsOut(const std::string& start_date, c
   builder.append_query(U("start"), start_date);
   builder.append_query(U("end"), end_date);
 
-  json::value json_response = SendRequest(methods::GET, builder.to_string());
-
-  auto array = json_response.as_array();
-
-  for (int i = 0; i < array.size(); ++i) {
-    auto employee_id = std::stoi(array[i].at(U("employeeId")).as_string());
-    auto timeoff_type = array[i].at(U("type"))[U("name")].as_string();
-    auto dates = array[i].at(U("dates")).as_object();
-    // Pick only dates where time off is active in the specified period
-    for(auto v = std::begin(dates); v != std::end(dates); v++) {
-      if (start_date <= v->first && v->first <= end_date) {
-        // Is there any value for current employee
-        auto it {ret.find(employee_id)};
-        if (it == ret.end()) {
-          // Initialize the value for the employee
-          ret[employee_id] = {{v->first, {{timeoff_type}}}};
-
-          continue;
-        }
-        // Is there any value for the current date with different time-off type?
-        auto it2 {it->second.find(v->first)};
-        if (it2 == std::end(it->second)) {
-          // Initialize the value for the current date
-          it->second[v->first] = {{timeoff_type}};
-
-          continue;
-        }
-        // There is some value for the current date already.
-        // We should add another time off type.
-        it2->second.push_back(timeoff_type);
-      }
-    }
-  }
-
-  return ret;
+  // The response is shared with the cache, so it is only read by reference
+  return ParseTimeOffRequests(
+      *SendRequest(methods::GET, builder.to_string()),
+      strtodays(start_date),
+      strtodays(end_date)
+  );
 }
-} // namespace bs
\ No newline at end of file
+} // namespace bs
@@ -1,64 +1,182 @@
-#include <cassert>
+#include <cctype>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include "base64.h"
 
-std::string base64_encode(const std::string& bindata) {
-  using std::string;
-  using std::numeric_limits;
-
-  if (bindata.size() > (numeric_limits<string::size_type>::max() / 4u) * 3u) {
-    throw std::length_error("Converting too large a string to base64.");
-  }
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BASE64_HAS_SSSE3 1
+#endif
 
-  const std::size_t binlen = bindata.size();
-  string retval((((binlen + 2) / 3) * 4), '=');
-  std::size_t outpos = 0;
-  int bits_collected = 0;
-  unsigned int accumulator = 0;
-  const string::const_iterator binend = bindata.end();
-
-  for (string::const_iterator i = bindata.begin(); i != binend; ++i) {
-    accumulator = (accumulator << 8) | (*i & 0xffu);
-    bits_collected += 8;
-    while (bits_collected >= 6) {
-      bits_collected -= 6;
-      retval[outpos++] = b64_table[(accumulator >> bits_collected) & 0x3fu];
-    }
-  }
-  if (bits_collected > 0) {
-    assert(bits_collected < 6);
-    accumulator <<= 6 - bits_collected;
-    retval[outpos++] = b64_table[accumulator & 0x3fu];
+namespace {
+/// @brief Encodes 3-byte groups while there are at least 3 input bytes left
+/// @returns The number of consumed input bytes
+std::size_t encode_scalar(const unsigned char* in, std::size_t len, char* out) {
+  std::size_t i = 0;
+  for (; i + 3 <= len; i += 3, out += 4) {
+    const uint32_t v = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+    out[0] = b64_table[v >> 18];
+    out[1] = b64_table[(v >> 12) & 0x3f];
+    out[2] = b64_table[(v >> 6) & 0x3f];
+    out[3] = b64_table[v & 0x3f];
   }
-  assert(outpos >= (retval.size() - 2));
-  assert(outpos <= retval.size());
 
-  return retval;
+  return i;
 }
 
-std::string base64_decode(const std::string& ascdata) {
-  using std::string;
-
-  string retval;
-  const string::const_iterator last = ascdata.end();
+/// @brief Decodes characters one by one. Whitespaces and padding characters are skipped.
+/// @returns The end of the output
+char* decode_scalar(const unsigned char* in, std::size_t len, char* out) {
   int bits_collected = 0;
   unsigned int accumulator = 0;
 
-  for (string::const_iterator i = ascdata.begin(); i != last; ++i) {
-    const int c = *i;
+  for (std::size_t i = 0; i < len; i++) {
+    const int c = in[i];
     if (std::isspace(c) || c == '=') {
       continue;
     }
-    if ((c > 127) || (c < 0) || (reverse_table[c] > 63)) {
+    if (c > 127 || reverse_table[c] > 63) {
       throw std::invalid_argument("It contains illegal characters in a base64 encoded string.");
     }
     accumulator = (accumulator << 6) | reverse_table[c];
     bits_collected += 6;
     if (bits_collected >= 8) {
       bits_collected -= 8;
-      retval += static_cast<char>((accumulator >> bits_collected) & 0xffu);
+      *out++ = static_cast<char>((accumulator >> bits_collected) & 0xffu);
+    }
+  }
+
+  return out;
+}
+
+#ifdef BASE64_HAS_SSSE3
+/// @brief Encodes 12-byte blocks into 16 characters while 16 input bytes can be loaded
+/// @returns The number of consumed input bytes
+__attribute__((target("ssse3")))
+std::size_t encode_ssse3(const unsigned char* in, std::size_t len, char* out) {
+  // Maps sextet indices to ASCII by adding an offset chosen from the index range
+  const __m128i shift_lut = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0
+  );
+  std::size_t i = 0;
+  for (; i + 16 <= len; i += 12, out += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    // Spreads every 3 bytes over a 32-bit lane and moves each sextet to its own byte
+    v = _mm_shuffle_epi8(v, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i ac = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+    const __m128i bd = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(ac, bd);
+
+    __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+    const __m128i chars = _mm_add_epi8(_mm_shuffle_epi8(shift_lut, range), indices);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), chars);
+  }
+
+  return i;
+}
+
+/// @brief Checks whether the characters are within the range [lo, hi]
+__attribute__((target("ssse3")))
+inline __m128i in_range(__m128i v, char lo, char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(hi + 1), v));
+}
+
+/// @brief Decodes 16-character blocks into 12 bytes until a block has a character other than the alphabet
+/// The output must have 4 bytes of slack because every block is stored as 16 bytes.
+/// @param consumed The number of consumed characters to set
+/// @returns The end of the output
+__attribute__((target("ssse3")))
+char* decode_ssse3(const unsigned char* in, std::size_t len, char* out, std::size_t* consumed) {
+  std::size_t i = 0;
+  for (; i + 16 <= len; i += 16, out += 12) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    // Bytes above 127 are negative, so they fall out of every range
+    const __m128i upper = in_range(v, 'A', 'Z');
+    const __m128i lower = in_range(v, 'a', 'z');
+    const __m128i digit = in_range(v, '0', '9');
+    const __m128i plus = _mm_cmpeq_epi8(v, _mm_set1_epi8('+'));
+    const __m128i slash = _mm_cmpeq_epi8(v, _mm_set1_epi8('/'));
+    const __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+    if (_mm_movemask_epi8(valid) != 0xffff) {
+      // Padding, whitespaces and errors are handled by the scalar decoder
+      break;
     }
+
+    __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+    shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+    shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+    shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(62 - '+')));
+    shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(63 - '/')));
+    const __m128i sextets = _mm_add_epi8(v, shift);
+
+    // Packs 4 sextets of every 32-bit lane into 3 bytes
+    const __m128i pairs = _mm_maddubs_epi16(sextets, _mm_set1_epi32(0x01400140));
+    const __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    const __m128i bytes = _mm_shuffle_epi8(lanes, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), bytes);
+  }
+  *consumed = i;
+
+  return out;
+}
+
+const bool kHasSsse3 = __builtin_cpu_supports("ssse3");
+#endif
+} // namespace
+
+std::string base64_encode(const std::string& bindata) {
+  if (bindata.size() > (std::numeric_limits<std::string::size_type>::max() / 4u) * 3u) {
+    throw std::length_error("Converting too large a string to base64.");
+  }
+
+  const std::size_t binlen = bindata.size();
+  std::string retval((((binlen + 2) / 3) * 4), '=');
+  auto in = reinterpret_cast<const unsigned char*>(bindata.data());
+  char* out = retval.data();
+  std::size_t i = 0;
+
+#ifdef BASE64_HAS_SSSE3
+  if (kHasSsse3) {
+    i = encode_ssse3(in, binlen, out);
+    out += i / 3 * 4;
+  }
+#endif
+  const std::size_t n = encode_scalar(in + i, binlen - i, out);
+  i += n;
+  out += n / 3 * 4;
+
+  // The last 1 or 2 bytes are followed by the padding which is already in place
+  if (i < binlen) {
+    const uint32_t v = (in[i] << 16) | (i + 1 < binlen ? in[i + 1] << 8 : 0);
+    out[0] = b64_table[v >> 18];
+    out[1] = b64_table[(v >> 12) & 0x3f];
+    if (i + 1 < binlen) {
+      out[2] = b64_table[(v >> 6) & 0x3f];
+    }
+  }
+
+  return retval;
+}
+
+std::string base64_decode(const std::string& ascdata) {
+  auto in = reinterpret_cast<const unsigned char*>(ascdata.data());
+  const std::size_t len = ascdata.size();
+  // The output is at most 3 bytes per 4 characters. Extra 4 bytes are the slack for the 16-byte stores.
+  std::string retval(len / 4 * 3 + 3 + 4, '\0');
+  char* out = retval.data();
+  std::size_t i = 0;
+
+#ifdef BASE64_HAS_SSSE3
+  if (kHasSsse3) {
+    out = decode_ssse3(in, len, out, &i);
   }
+#endif
+  out = decode_scalar(in + i, len - i, out);
+  retval.resize(out - retval.data());
 
   return retval;
 }
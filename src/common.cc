@@ -1,7 +1,11 @@
 #include <chrono>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <tuple>
+#include <ctime>
 #include <cpprest/version.h>
+#include "common.h"
 
 namespace bs {
 const std::string Version() {
@@ -43,4 +47,94 @@ uint64_t strtotime(const std::string& s) {
 
   return std::stoi(ss.str());
 }
+
+int32_t strtodays(const std::string& s) {
+  if (s.size() < 10) {
+    throw std::invalid_argument("date should be provided in the Y-m-d format.");
+  }
+
+  auto digits = [&s](std::size_t pos, std::size_t n) {
+    int v = 0;
+    for (std::size_t i = pos; i < pos + n; ++i) {
+      if (s[i] < '0' || s[i] > '9') {
+        throw std::invalid_argument("date should be provided in the Y-m-d format.");
+      }
+      v = v * 10 + (s[i] - '0');
+    }
+    return v;
+  };
+
+  // Converts the civil date to a day number using the proleptic Gregorian calendar
+  const int m = digits(5, 2);
+  const int d = digits(8, 2);
+  const int y = digits(0, 4) - (m <= 2 ? 1 : 0);
+  const int era = (y >= 0 ? y : y - 399) / 400;
+  const int yoe = y - era * 400;
+  const int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+  return era * 146097 + doe - 719468;
+}
+
+int32_t GetCurrentDay(const long& offset) {
+  const long t = std::time(nullptr) + offset;
+
+  return static_cast<int32_t>(t >= 0 ? t / 86400 : (t - 86399) / 86400);
+}
+
+void BambooHrTimeOffList::Add(int employee_id, int32_t day, const std::string& type_name) {
+  auto it = type_ids.find(type_name);
+  if (it == type_ids.end()) {
+    it = type_ids.emplace(type_name, type_names.size()).first;
+    type_names.push_back(type_name);
+  }
+
+  entries.push_back({employee_id, day, it->second});
+}
+
+void BambooHrTimeOffList::Sort() {
+  auto key = [](const Entry& e) {
+    return std::make_tuple(e.employee_id, e.day, e.type);
+  };
+
+  std::sort(entries.begin(), entries.end(), [&key](const Entry& a, const Entry& b) {
+    return key(a) < key(b);
+  });
+  entries.erase(
+      std::unique(entries.begin(), entries.end(), [&key](const Entry& a, const Entry& b) {
+        return key(a) == key(b);
+      }),
+      entries.end()
+  );
+}
+
+std::pair<BambooHrTimeOffList::const_iterator, BambooHrTimeOffList::const_iterator> BambooHrTimeOffList::Find(
+    int employee_id,
+    int32_t day
+) const {
+  return std::equal_range(
+      entries.begin(),
+      entries.end(),
+      Entry {employee_id, day, 0},
+      [](const Entry& a, const Entry& b) {
+        return a.employee_id < b.employee_id || (a.employee_id == b.employee_id && a.day < b.day);
+      }
+  );
+}
+
+const std::string* BambooHrTimeOffList::FindType(int employee_id, int32_t day) const {
+  const auto [first, last] = Find(employee_id, day);
+  if (first == last) {
+    return nullptr;
+  }
+
+  const std::string* type_name = &TypeName(first->type);
+  for (auto it = std::next(first); it != last; ++it) {
+    if (TypeName(it->type) < *type_name) {
+      type_name = &TypeName(it->type);
+    }
+  }
+
+  return type_name;
+}
 } // namespace bs
\ No newline at end of file
@@ -1,85 +1,496 @@
-#include <leveldb/db.h>
-#include "encryption.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
 #include "db.h"
 
 using namespace web;
 
 namespace bs {
-bool DB::GetOrgs(std::map<std::string, json::value>* res) {
-  leveldb::Iterator* it = db->NewIterator(leveldb::ReadOptions());
-  for (it->Seek(kTeamPrefix + ":"); it->Valid() && it->key().ToString() < kTeamPrefix + "~"; it->Next()) {
-    leveldb::Slice p = it->key();
-    p.remove_prefix(kTeamPrefix.size() + 1);
-    std::string slack_team_id = p.ToString();
-    auto value = json::value::parse(decrypt(it->value().ToString(), kCryptokey));
+bool DB::GetOrgs(std::vector<Org>* res) {
+  *res = orgs.GetOrgs();
 
-    if (!value.is_object()) {
-      // invalid data
-      continue;
+  return true;
+}
+
+bool DB::GetAccessToken(const std::string& slack_team_id, const std::string& slack_user_id, std::string* res) {
+  return orgs.GetUserToken(slack_team_id, slack_user_id, res);
+}
+
+/// @brief Helper function which checks whether a record key has the prefix
+/// @param key A record key
+/// @param prefix A key prefix without separator
+static bool HasKeyPrefix(std::string_view key, const std::string& prefix) {
+  return key.size() > prefix.size() && key.compare(0, prefix.size(), prefix) == 0 && key[prefix.size()] == ':';
+}
+
+/// @brief Helper function which builds a key of the install callbacks time index.
+/// The time is zero-padded, so the keys are ordered by time.
+/// @param time Unix time when the callback has been created
+/// @param trigger_id A Slack API action's trigger identifier
+static std::string CallbackIndexKey(int64_t time, const std::string& trigger_id) {
+  char buf[21];
+  snprintf(buf, sizeof(buf), "%020lld", static_cast<long long>(std::max<int64_t>(time, 0)));
+
+  return DB::kCallbackIndexPrefix + ":" + buf + ":" + trigger_id;
+}
+
+/// @brief Helper function which converts organizations, tokens and callbacks stored as JSON to binary records
+/// @param key A record key
+/// @param data A decrypted value to convert
+/// @returns TRUE if the value has been converted
+static bool UpgradeJsonRecord(std::string_view key, std::string* data) {
+  if (!IsJsonRecord(*data)) {
+    return false;
+  }
+
+  if (HasKeyPrefix(key, DB::kTeamPrefix)) {
+    Org org;
+    if (DecodeRecord(*data, &org)) {
+      *data = EncodeRecord(org);
+      return true;
     }
+  } else if (HasKeyPrefix(key, DB::kUserPrefix)) {
+    UserToken token;
+    if (DecodeRecord(*data, &token)) {
+      *data = EncodeRecord(token);
+      return true;
+    }
+  } else if (HasKeyPrefix(key, DB::kCallbackPrefix)) {
+    InstallCallback callback;
+    if (DecodeRecord(*data, &callback)) {
+      *data = EncodeRecord(callback);
+      return true;
+    }
+  }
 
-    json::value user_token;
-    if (!GetUserToken(slack_team_id, value[U("admin_user")].as_string(), &user_token)) {
-      continue;
+  return false;
+}
+
+/// @brief Helper function which checks whether a string is valid UTF-8
+static bool IsValidUtf8(std::string_view s) {
+  for (std::size_t i = 0; i < s.size();) {
+    const auto c = static_cast<unsigned char>(s[i]);
+    std::size_t length;
+    if (c < 0x80) {
+      length = 1;
+    } else if (c >= 0xc2 && c <= 0xdf) {
+      length = 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+      length = 3;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+      length = 4;
+    } else {
+      return false;
+    }
+    if (i + length > s.size()) {
+      return false;
     }
+    for (std::size_t j = 1; j < length; j++) {
+      if ((static_cast<unsigned char>(s[i + j]) & 0xc0) != 0x80) {
+        return false;
+      }
+    }
+    i += length;
+  }
 
-    value[U("token")] = user_token;
+  return true;
+}
 
-    (*res)[slack_team_id] = value;
+/// @brief Helper function which checks that a value decrypted from the unauthenticated legacy format
+/// looks like the record stored under the key. A corrupted value decrypts to garbage which must not be re-sealed.
+/// @param key A record key
+/// @param data A decrypted value
+static bool IsReadableRecord(std::string_view key, const std::string& data) {
+  if (HasKeyPrefix(key, DB::kTeamPrefix)) {
+    Org org;
+    return DecodeRecord(data, &org);
+  }
+  if (HasKeyPrefix(key, DB::kUserPrefix)) {
+    UserToken token;
+    return DecodeRecord(data, &token);
+  }
+  if (HasKeyPrefix(key, DB::kCallbackPrefix)) {
+    InstallCallback callback;
+    return DecodeRecord(data, &callback);
+  }
+  if (HasKeyPrefix(key, DB::kStatusPrefix) || HasKeyPrefix(key, DB::kResponseCachePrefix)) {
+    try {
+      return json::value::parse(data).is_object();
+    } catch (std::exception&) {
+      return false;
+    }
+  }
+
+  // Who-is-out messages are text
+  return IsValidUtf8(data);
+}
+
+void DB::LoadOrgs() {
+  const std::string team_prefix {kTeamPrefix + ":"};
+  db->Scan(team_prefix, [this, &team_prefix](std::string_view key, std::string_view value) {
+    try {
+      Org org;
+      if (!DecodeRecord(DecryptRecord(std::string {key}, std::string {value}), &org)) {
+        // invalid data
+        return true;
+      }
+      org.slack_team_id = key.substr(team_prefix.size());
+      orgs.PutOrg(std::move(org));
+    } catch (std::exception&) {
+      // A record which can not be read is skipped as invalid data
+    }
+
+    return true;
+  });
+
+  // User records are keyed as USER:<user ID>:<team ID>
+  const std::string user_prefix {kUserPrefix + ":"};
+  db->Scan(user_prefix, [this, &user_prefix](std::string_view key, std::string_view value) {
+    const auto sep = key.find(':', user_prefix.size());
+    if (sep == std::string_view::npos) {
+      return true;
+    }
+
+    try {
+      UserToken token;
+      if (DecodeRecord(DecryptRecord(std::string {key}, std::string {value}), &token)) {
+        orgs.PutUserToken(
+            std::string {key.substr(sep + 1)},
+            std::string {key.substr(user_prefix.size(), sep - user_prefix.size())},
+            std::move(token.access_token)
+        );
+      }
+    } catch (std::exception&) {
+    }
+
+    return true;
+  });
+}
+
+bool DB::PutRecord(const std::string& key, const std::string& data) {
+  const auto value = cipher.Encrypt(data, key);
+
+  std::lock_guard<std::mutex> lock {write_mutex};
+  return db->Put(key, value, IsSyncWrite(false));
+}
+
+std::string DB::OpenRecord(const std::string& key, const std::string& value, Cipher::Format* format) {
+  if (migration_pending) {
+    return cipher.DecryptAnyFormat(value, key, format);
+  }
+  // Once every record has been migrated, a record of another format can only have been tampered with
+  if (format != nullptr) {
+    *format = Cipher::kCurrentFormat;
+  }
+
+  return cipher.Decrypt(value, key);
+}
+
+std::string DB::DecryptRecord(const std::string& key, const std::string& value) {
+  Cipher::Format format;
+  auto data = OpenRecord(key, value, &format);
+  if (format == Cipher::kFormatLegacy && !IsReadableRecord(key, data)) {
+    throw std::runtime_error("Unable to decrypt record " + key + ". The value is corrupted.");
+  }
+  if (format != Cipher::kCurrentFormat) {
+    MigrateRecord(key, value, data);
   }
 
+  return data;
+}
+
+void DB::MigrateRecord(const std::string& key, const std::string& value, const std::string& data) {
+  const auto migrated = cipher.Encrypt(data, key);
+
+  std::lock_guard<std::mutex> lock {write_mutex};
+  std::string current;
+  // The record may have been replaced or deleted since it was read
+  if (!db->Get(key, &current) || current != value) {
+    return;
+  }
+  if (db->Put(key, migrated, IsSyncWrite(false))) {
+    ++migrated_records;
+  }
+}
+
+bool DB::MigrateStorage(uint64_t* migrated, uint64_t* failed) {
+  const std::string version_key {kMetaPrefix + ":format"};
+  const std::string version {std::to_string(kStorageFormatVersion)};
+  *migrated = 0;
+  *failed = 0;
+
+  std::string current_version;
+  if (db->Get(version_key, &current_version) && current_version == version) {
+    return true;
+  }
+
+  // The records are written in batches to keep memory usage bounded on large databases
+  constexpr std::size_t kBatchSize {1000};
+  bool written = true;
+  uint64_t converted = 0;
+  StorageBatch batch;
+
+  std::lock_guard<std::mutex> lock {write_mutex};
+  const bool scanned = db->Scan("", [&](std::string_view key, std::string_view value) {
+    // Neither metadata nor index entries are encrypted
+    if (HasKeyPrefix(key, kMetaPrefix) || HasKeyPrefix(key, kCallbackIndexPrefix)) {
+      return true;
+    }
+    // Who-is-out messages of the previous versions are not responses. The sync which follows the migration
+    // stores the rendered ones.
+    if (HasKeyPrefix(key, kWhoIsOutPrefix)) {
+      batch.Delete(std::string {key});
+      ++converted;
+      return true;
+    }
+
+    const bool encrypted_as_current = Cipher::GetFormat(value) == Cipher::kCurrentFormat;
+    // Organizations, tokens and callbacks have to be decrypted to find out whether they are JSON
+    const bool typed = HasKeyPrefix(key, kTeamPrefix)
+        || HasKeyPrefix(key, kUserPrefix)
+        || HasKeyPrefix(key, kCallbackPrefix);
+    if (encrypted_as_current && !typed) {
+      return true;
+    }
+
+    try {
+      Cipher::Format format;
+      std::string data {cipher.DecryptAnyFormat(std::string {value}, key, &format)};
+      if (format == Cipher::kFormatLegacy && !IsReadableRecord(key, data)) {
+        throw std::runtime_error("The value is corrupted.");
+      }
+      const bool upgraded = UpgradeJsonRecord(key, &data);
+
+      // Callbacks stored by the previous versions are not in the time index
+      InstallCallback callback;
+      if (HasKeyPrefix(key, kCallbackPrefix) && DecodeRecord(data, &callback)) {
+        batch.Put(CallbackIndexKey(callback.time, std::string {key.substr(kCallbackPrefix.size() + 1)}), "");
+      }
+
+      if (upgraded || !encrypted_as_current) {
+        batch.Put(std::string {key}, cipher.Encrypt(data, key));
+        ++converted;
+      }
+    } catch (std::exception&) {
+      // Such record can not be read anyway. It's left as is and counted instead of being re-sealed.
+      ++*failed;
+      return true;
+    }
+
+    if (batch.size() >= kBatchSize) {
+      if (!db->Write(batch, IsSyncWrite(false))) {
+        written = false;
+        return false;
+      }
+      *migrated += converted;
+      converted = 0;
+      batch.Clear();
+    }
+
+    return true;
+  });
+
+  if (!scanned || !written || !db->Write(batch, IsSyncWrite(false))) {
+    return false;
+  }
+  *migrated += converted;
+  migrated_records += *migrated;
+
+  if (*migrated > 0) {
+    db->Compact();
+  }
+
+  // Records which could not be read are not retried. They are rejected from now on like any other corrupted record.
+  if (!db->Put(version_key, version, IsSyncWrite(false))) {
+    return false;
+  }
+  migration_pending = false;
+
   return true;
 }
 
-bool DB::PutWioData(const std::string& slack_team_id, const std::string& message) {
-  auto s = db->Put(
-      leveldb::WriteOptions(),
-      kWhoIsOutPrefix + ":" + slack_team_id,
-      encrypt(message, kCryptokey)
-  );
-  return s.ok() ? true : false;
+bool DB::PutWioResponse(const std::string& slack_team_id, const std::string& response) {
+  if (!PutRecord(kWhoIsOutPrefix + ":" + slack_team_id, response)) {
+    return false;
+  }
+
+  auto entry = std::make_shared<const std::string>(response);
+
+  std::unique_lock<std::shared_mutex> lock {wio_cache_mutex};
+  wio_cache[slack_team_id] = std::move(entry);
+
+  return true;
 }
 
-std::string DB::GetWioData(const std::string& slack_team_id) {
-  std::string message;
-  auto s = db->Get(
-      leveldb::ReadOptions(),
-      kWhoIsOutPrefix + ":" + slack_team_id,
-      &message
-  );
-  return s.ok() ? decrypt(message, kCryptokey) : "";
+bool DB::GetWioResponse(const std::string& slack_team_id, std::string* response) {
+  WioCacheEntry entry;
+  bool cached = false;
+  {
+    std::shared_lock<std::shared_mutex> lock {wio_cache_mutex};
+    if (auto it = wio_cache.find(slack_team_id); it != wio_cache.end()) {
+      entry = it->second;
+      cached = true;
+    }
+  }
+
+  if (cached) {
+    ++wio_cache_hits;
+  } else {
+    ++wio_cache_misses;
+
+    const std::string key {kWhoIsOutPrefix + ":" + slack_team_id};
+    std::string data;
+    bool found = false;
+    if (!db->Find(key, &data, &found)) {
+      return false;
+    }
+    if (found) {
+      try {
+        entry = std::make_shared<const std::string>(DecryptRecord(key, data));
+      } catch (std::exception&) {
+        return false;
+      }
+    }
+
+    // It does not replace a response that has been put in the meantime
+    std::unique_lock<std::shared_mutex> lock {wio_cache_mutex};
+    entry = wio_cache.emplace(slack_team_id, std::move(entry)).first->second;
+  }
+
+  if (entry) {
+    *response = *entry;
+  } else {
+    response->clear();
+  }
+
+  return true;
 }
 
-bool DB::GetUserToken(const std::string& slack_team_id, const std::string& slack_user_id, json::value* res) {
-  std::string token;
-  // Get admin token for value
-  leveldb::Status s = db->Get(
-      leveldb::ReadOptions(),
-      kUserPrefix + ":" + slack_user_id + ":" + slack_team_id,
-      &token
-  );
-  if (!s.ok()) {
-    // there is no token in database
+/// @brief Helper function which serializes a status snapshot
+/// @param users Slack users who exist in BambooHR
+/// @param reconciled_at Unix time when the snapshot was refreshed from Slack last time
+/// @returns Serialized JSON snapshot
+static std::string SerializeStatusSnapshot(const SlackUsersList& users, const uint64_t& reconciled_at) {
+  json::value jv;
+  json::value list = json::value::array(users.size());
+  std::size_t i = 0;
+
+  for (const auto& user : users) {
+    json::value u;
+    u[U("id")] = json::value::string(user.slack_id);
+    u[U("email")] = json::value::string(user.email);
+    u[U("name")] = json::value::string(user.name);
+    u[U("real_name")] = json::value::string(user.real_name);
+    u[U("status_text")] = json::value::string(user.status_text);
+    u[U("status_emoji")] = json::value::string(user.status_emoji);
+    u[U("status_expiration")] = json::value::number(static_cast<int64_t>(user.status_expiration));
+    u[U("status_text_canonical")] = json::value::string(user.status_text_canonical);
+    u[U("employee_id")] = json::value::number(user.bamboohr_employee_id);
+    u[U("tz_offset")] = json::value::number(user.tz_offset);
+    u[U("is_privileged")] = json::value::boolean(user.is_privileged);
+    list[i++] = std::move(u);
+  }
+
+  jv[U("time")] = json::value::number(reconciled_at);
+  jv[U("users")] = std::move(list);
+
+  return jv.serialize();
+}
+
+bool DB::PutStatusSnapshot(
+    const std::string& slack_team_id,
+    const SlackUsersList& users,
+    const uint64_t& reconciled_at
+) {
+  return PutRecord(kStatusPrefix + ":" + slack_team_id, SerializeStatusSnapshot(users, reconciled_at));
+}
+
+bool DB::GetStatusSnapshot(const std::string& slack_team_id, SlackUsersList* users, uint64_t* reconciled_at) {
+  const std::string key {kStatusPrefix + ":" + slack_team_id};
+  std::string data;
+  if (!db->Get(key, &data)) {
+    // there is no snapshot in database
+    return false;
+  }
+
+  SlackUsersList snapshot;
+  try {
+    auto jv = json::value::parse(DecryptRecord(key, data));
+    if (!jv.is_object() || !jv.has_field(U("users")) || !jv.has_field(U("time"))) {
+      throw std::runtime_error("Invalid status snapshot.");
+    }
+
+    const auto& list = jv.at(U("users")).as_array();
+    snapshot.reserve(list.size());
+    for (const auto& u : list) {
+      snapshot.push_back({
+          u.at(U("id")).as_string(),
+          u.at(U("email")).as_string(),
+          u.at(U("name")).as_string(),
+          u.at(U("real_name")).as_string(),
+          u.at(U("status_text")).as_string(),
+          u.at(U("status_emoji")).as_string(),
+          static_cast<long int>(u.at(U("status_expiration")).as_number().to_int64()),
+          u.at(U("status_text_canonical")).as_string(),
+          u.at(U("employee_id")).as_integer(),
+          u.at(U("tz_offset")).as_integer(),
+          u.at(U("is_privileged")).as_bool()
+      });
+    }
+    *reconciled_at = jv.at(U("time")).as_number().to_int64();
+  } catch (std::exception&) {
+    // The snapshot is corrupt or can not be decrypted. It's dropped, so the caller falls back to
+    // the full reconciliation which stores a new one.
+    db->Delete(key, IsSyncWrite(false));
+
     return false;
   }
+  *users = std::move(snapshot);
+
+  return true;
+}
+
+bool DB::PutResponseCache(const std::string& key, const std::string& data) {
+  return PutRecord(kResponseCachePrefix + ":" + key, data);
+}
 
-  (*res) = json::value::parse(decrypt(token, kCryptokey));
-  if (!(*res).is_object()) {
-    // invalid data
+bool DB::GetResponseCache(const std::string& key, std::string* res) {
+  const std::string record_key {kResponseCachePrefix + ":" + key};
+  std::string data;
+  if (!db->Get(record_key, &data)) {
     return false;
   }
 
+  *res = DecryptRecord(record_key, data);
+
   return true;
 }
 
-bool DB::PutUserToken(const std::string& slack_team_id, const std::string& slack_user_id, const std::string& token) {
-  leveldb::Status s = db->Put(
-      leveldb::WriteOptions(),
-      kUserPrefix + ":" + slack_user_id + ":" + slack_team_id,
-      encrypt(token, kCryptokey)
-  );
+bool DB::DeleteResponseCache(const std::string& key) {
+  return db->Delete(kResponseCachePrefix + ":" + key, IsSyncWrite(false));
+}
+
+bool DB::GetUserToken(const std::string& slack_team_id, const std::string& slack_user_id, UserToken* res) {
+  const std::string key {kUserPrefix + ":" + slack_user_id + ":" + slack_team_id};
+  std::string token;
+  // Get admin token for value
+  if (!db->Get(key, &token)) {
+    // there is no token in database
+    return false;
+  }
+
+  // FALSE on invalid data
+  return DecodeRecord(DecryptRecord(key, token), res);
+}
+
+bool DB::PutUserToken(const std::string& slack_team_id, const std::string& slack_user_id, const UserToken& token) {
+  if (!PutRecord(kUserPrefix + ":" + slack_user_id + ":" + slack_team_id, EncodeRecord(token))) {
+    return false;
+  }
+  orgs.PutUserToken(slack_team_id, slack_user_id, token.access_token);
 
-  return s.ok() ? true : false;
+  return true;
 }
 
 bool DB::PutOrg(
@@ -88,62 +499,184 @@ bool DB::PutOrg(
     const std::string& slack_team_id,
     const std::string& slack_user_id
 ) {
-  using web::json::value;
-  value jv;
-  jv[U("bamboohr_secret")] = value::string(bamboo_hr_secret);
-  jv[U("bamboohr_org")] = value::string(bamboo_hr_org);
-  jv[U("admin_user")] = value::string(slack_user_id);
+  Org org {slack_team_id, bamboo_hr_org, bamboo_hr_secret, slack_user_id, ""};
 
-  leveldb::Status s = db->Put(
-    leveldb::WriteOptions(),
-    kTeamPrefix + ":" + slack_team_id,
-    encrypt(jv.serialize(), kCryptokey)
-  );
+  if (!PutRecord(kTeamPrefix + ":" + slack_team_id, EncodeRecord(org))) {
+    return false;
+  }
+  orgs.PutOrg(std::move(org));
 
-  return s.ok() ? true : false;
+  return true;
 }
 
-bool DB::PutInstallCallback(
-    const std::string& trigger_id,
-    const web::json::value& data
-) {
-  leveldb::Status s = db->Put(
-      leveldb::WriteOptions(),
-      kCallbackPrefix + ":" + trigger_id,
-      encrypt(data.serialize(), kCryptokey)
-  );
+bool DB::PutInstallCallback(const std::string& trigger_id, const InstallCallback& data) {
+  StorageBatch batch;
+  const std::string key {kCallbackPrefix + ":" + trigger_id};
+  batch.Put(key, cipher.Encrypt(EncodeRecord(data), key));
+  // The index lets expired callbacks be found without reading the others
+  batch.Put(CallbackIndexKey(data.time, trigger_id), "");
 
-  return s.ok() ? true : false;
+  std::lock_guard<std::mutex> lock {write_mutex};
+  return db->Write(batch, IsSyncWrite(false));
 }
 
-bool DB::GetInstallCallback(const std::string& trigger_id, web::json::value* res) {
+bool DB::GetInstallCallback(const std::string& trigger_id, InstallCallback* res) {
+  const std::string key {kCallbackPrefix + ":" + trigger_id};
   std::string data;
   // Get admin token for value
-  leveldb::Status s = db->Get(
-      leveldb::ReadOptions(),
-      kCallbackPrefix + ":" + trigger_id,
-      &data
-  );
-  if (!s.ok()) {
+  if (!db->Get(key, &data)) {
     // there is no data in database
     return false;
   }
 
-  (*res) = json::value::parse(decrypt(data, kCryptokey));
-  if (!(*res).is_object()) {
-    // invalid data
+  // FALSE on invalid data
+  if (!DecodeRecord(DecryptRecord(key, data), res)) {
     return false;
   }
 
-  return true;
+  // The reaper runs periodically, so an expired callback may still be there
+  const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+  return res->time >= now - static_cast<int64_t>(callback_ttl);
 }
 
 bool DB::DeleteInstallCallback(const std::string& trigger_id) {
-  leveldb::Status s = db->Delete(
-      leveldb::WriteOptions(),
-      kCallbackPrefix + ":" + trigger_id
-  );
+  const std::string key {kCallbackPrefix + ":" + trigger_id};
+  StorageBatch batch;
+  batch.Delete(key);
+
+  std::lock_guard<std::mutex> lock {write_mutex};
+  std::string data;
+  InstallCallback callback;
+  try {
+    if (db->Get(key, &data) && DecodeRecord(OpenRecord(key, data), &callback)) {
+      batch.Delete(CallbackIndexKey(callback.time, trigger_id));
+    }
+  } catch (std::exception&) {
+    // An index entry which is left is deleted once it expires
+  }
+
+  return db->Write(batch, IsSyncWrite(false));
+}
+
+bool DB::ExpireInstallCallbacks(int64_t created_before, uint64_t* expired) {
+  *expired = 0;
+
+  // The index is ordered by time, so the scan stops at the first callback which has not expired yet
+  const std::string end_key {CallbackIndexKey(created_before, "")};
+  const std::size_t trigger_id_pos = end_key.size();
+  std::vector<std::string> index_keys;
+  const bool scanned = db->Scan(kCallbackIndexPrefix + ":", [&](std::string_view key, std::string_view) {
+    if (key >= end_key) {
+      return false;
+    }
+    index_keys.emplace_back(key);
+
+    return true;
+  });
+  if (!scanned) {
+    return false;
+  }
+
+  // The callbacks are deleted in batches, so the writers are not blocked for long
+  constexpr std::size_t kBatchSize {1000};
+  for (std::size_t i = 0; i < index_keys.size(); i += kBatchSize) {
+    StorageBatch batch;
+    uint64_t deleted = 0;
+
+    std::lock_guard<std::mutex> lock {write_mutex};
+    for (std::size_t j = i; j < std::min(i + kBatchSize, index_keys.size()); ++j) {
+      const std::string& index_key = index_keys[j];
+      const std::string trigger_id {index_key.substr(trigger_id_pos)};
+      const std::string key {kCallbackPrefix + ":" + trigger_id};
+
+      std::string data;
+      if (db->Get(key, &data)) {
+        // The callback may have been replaced by a newer one with the same trigger ID
+        bool stale = true;
+        try {
+          InstallCallback callback;
+          stale = !DecodeRecord(OpenRecord(key, data), &callback)
+              || CallbackIndexKey(callback.time, trigger_id) == index_key;
+        } catch (std::exception&) {
+          // A record which can not be read is deleted as well
+        }
+        if (stale) {
+          batch.Delete(key);
+          ++deleted;
+        }
+      }
+      batch.Delete(index_key);
+    }
+
+    if (!db->Write(batch, IsSyncWrite(false))) {
+      return false;
+    }
+    *expired += deleted;
+    expired_callbacks += deleted;
+  }
+
+  return true;
+}
+
+void DB::Batch::Put(const std::string& key, const std::string& value) {
+  const auto encrypted = db.cipher.Encrypt(value, key);
+
+  std::lock_guard<std::mutex> lock {mutex};
+  batch.Put(key, encrypted);
+}
+
+void DB::Batch::PutWioResponse(const std::string& slack_team_id, const std::string& response) {
+  Put(kWhoIsOutPrefix + ":" + slack_team_id, response);
+
+  auto entry = std::make_shared<const std::string>(response);
+  std::lock_guard<std::mutex> lock {mutex};
+  wio_updates[slack_team_id] = std::move(entry);
+}
+
+void DB::Batch::PutStatusSnapshot(
+    const std::string& slack_team_id,
+    const SlackUsersList& users,
+    const uint64_t& reconciled_at
+) {
+  Put(kStatusPrefix + ":" + slack_team_id, SerializeStatusSnapshot(users, reconciled_at));
+}
+
+void DB::Batch::PutSyncStats(const web::json::value& stats) {
+  std::lock_guard<std::mutex> lock {mutex};
+  batch.Put(kMetaPrefix + ":sync", stats.serialize());
+}
+
+bool DB::Write(Batch* batch) {
+  std::lock_guard<std::mutex> batch_lock {batch->mutex};
+  {
+    std::lock_guard<std::mutex> lock {write_mutex};
+    if (!db->Write(batch->batch, IsSyncWrite(true))) {
+      return false;
+    }
+  }
+
+  // The messages become visible only after they have been committed
+  {
+    std::unique_lock<std::shared_mutex> lock {wio_cache_mutex};
+    for (auto& [slack_team_id, entry] : batch->wio_updates) {
+      wio_cache[slack_team_id] = std::move(entry);
+    }
+  }
+
+  batch->batch.Clear();
+  batch->wio_updates.clear();
+
+  return true;
+}
+
+bool DB::GetSyncStats(json::value* res) {
+  std::string data;
+  if (!db->Get(kMetaPrefix + ":sync", &data)) {
+    return false;
+  }
+  *res = json::value::parse(data);
 
-  return s.ok() ? true : false;
+  return res->is_object();
 }
-} // namespace bs
\ No newline at end of file
+} // namespace bs
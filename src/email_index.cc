@@ -0,0 +1,84 @@
+#include "email_index.h"
+
+namespace bs {
+uint64_t EmailIndex::Hash(std::string_view s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (char c : s) {
+    h ^= static_cast<unsigned char>(Lower(c));
+    h *= 1099511628211ULL;
+  }
+
+  return h;
+}
+
+EmailIndex::EmailIndex(const BambooHrUsersList& users) : count(0) {
+  // Keeps the load factor at or below 0.5
+  std::size_t capacity = 16;
+  while (capacity < users.size() * 2) {
+    capacity <<= 1;
+  }
+  slots.assign(capacity, {0, 0, 0, 0});
+
+  std::size_t pool_size = 0;
+  for (const auto& [email, employee_id] : users) {
+    pool_size += email.size();
+  }
+  pool.reserve(pool_size);
+
+  const std::size_t mask = capacity - 1;
+
+  for (const auto& [email, employee_id] : users) {
+    if (email.empty()) {
+      continue;
+    }
+
+    // Emails that differ in case only are the same email, the first one wins
+    int found;
+    if (Find(email, &found)) {
+      continue;
+    }
+
+    const uint64_t h = Hash(email);
+    std::size_t i = h & mask;
+    while (slots[i].length != 0) {
+      i = (i + 1) & mask;
+    }
+
+    slots[i] = {h, static_cast<uint32_t>(pool.size()), static_cast<uint32_t>(email.size()), employee_id};
+    for (char c : email) {
+      pool.push_back(Lower(c));
+    }
+    ++count;
+  }
+}
+
+bool EmailIndex::Find(std::string_view email, int* employee_id) const {
+  if (email.empty()) {
+    return false;
+  }
+
+  const std::size_t mask = slots.size() - 1;
+  const uint64_t h = Hash(email);
+
+  for (std::size_t i = h & mask; slots[i].length != 0; i = (i + 1) & mask) {
+    const Slot& slot = slots[i];
+    if (slot.hash != h || slot.length != email.size()) {
+      continue;
+    }
+
+    const char* interned = pool.data() + slot.offset;
+    std::size_t j = 0;
+    while (j < email.size() && Lower(email[j]) == interned[j]) {
+      ++j;
+    }
+
+    if (j == email.size()) {
+      *employee_id = slot.employee_id;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+} // namespace bs
@@ -1,11 +1,26 @@
-#include <iomanip>
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <limits>
+#include <stdexcept>
 #include <openssl/hmac.h>
 #include <openssl/evp.h>
+#include <openssl/rand.h>
 #include "base64.h"
 #include "encryption.h"
 
 namespace bs {
+std::string to_hex(const unsigned char* data, std::size_t size) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  std::string ret(size * 2, '\0');
+  for (std::size_t i = 0; i < size; i++) {
+    ret[2 * i] = kDigits[data[i] >> 4];
+    ret[2 * i + 1] = kDigits[data[i] & 0x0f];
+  }
+
+  return ret;
+}
+
 std::string hmac_sha256(const std::string& data, const std::string& key) {
   unsigned int diglen;
   unsigned char result[EVP_MAX_MD_SIZE];
@@ -18,13 +33,7 @@ std::string hmac_sha256(const std::string& data, const std::string& key) {
       &diglen
   );
 
-  std::stringstream ss;
-  ss << std::hex << std::setfill('0');
-  for (int i = 0; i < 32; i++) {
-    ss << std::hex << std::setw(2) << (unsigned int)digest[i];
-  }
-
-  return ss.str();
+  return to_hex(digest, diglen);
 }
 
 void create_key(
@@ -59,70 +68,254 @@ void create_key(
   }
 }
 
-std::string encrypt(const std::string& data, const std::string& secret)
-{
-  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-  const EVP_CIPHER *cipher = EVP_aes_256_cfb8();
-  uint8_t key_length = EVP_CIPHER_key_length(cipher);
-  uint8_t block_size = EVP_CIPHER_block_size(cipher);
-  uint8_t iv_length = EVP_CIPHER_iv_length(cipher);
-  int u_len, f_len;
-  unsigned char rkey[key_length];
-  unsigned char iv[iv_length];
-  // calculate the length of encoded string
-  int dest_length = block_size > 1 ? block_size * (data.length() / block_size) + block_size : data.length();
-  // encoded string result
-  unsigned char dest[dest_length];
-  memset(dest, 0, dest_length);
-
-  // Creates a key of the specific length for this type of the cipher algorithm
-  create_key(reinterpret_cast<const unsigned char*>(secret.c_str()), secret.length(), rkey, key_length, iv, iv_length);
-
-  EVP_EncryptInit(ctx, cipher, rkey, iv);
-  EVP_CIPHER_CTX_set_padding(ctx, true);
-  EVP_EncryptUpdate(ctx, dest, &u_len, reinterpret_cast<const unsigned char*>(data.c_str()), data.length());
-  EVP_EncryptFinal(ctx, dest + u_len, &f_len);
-  EVP_CIPHER_CTX_free(ctx);
-
-  if (u_len + f_len != dest_length) {
-    throw std::runtime_error("Unable to encrypt string. Unexpected result length.");
-  };
-
-  std::stringstream ss;
-  for (int i = 0; i < dest_length; i++) {
-    ss << dest[i];
-  }
-
-  return base64_encode(ss.str());
+namespace {
+/// @brief A cipher context of the current thread
+struct ThreadCipherContext {
+  ThreadCipherContext() : ctx(EVP_CIPHER_CTX_new()) {}
+  ~ThreadCipherContext() {
+    EVP_CIPHER_CTX_free(ctx);
+  }
+
+  /// @brief Initializes the context for the next value
+  /// The key schedule is computed once per cipher. Afterwards only the IV is reset.
+  EVP_CIPHER_CTX* Init(
+      uint64_t cipher_id,
+      const EVP_CIPHER* cipher,
+      const unsigned char* key,
+      const unsigned char* iv,
+      bool encrypt
+  ) {
+    if (ctx == nullptr) {
+      throw std::runtime_error("Unable to allocate cipher context.");
+    }
+    const bool ok = owner == cipher_id
+        ? EVP_CipherInit_ex(ctx, nullptr, nullptr, nullptr, iv, encrypt)
+        : EVP_CipherInit_ex(ctx, cipher, nullptr, key, iv, encrypt);
+    // The context is keyed from scratch next time if anything fails
+    owner = ok ? cipher_id : 0;
+    if (!ok) {
+      throw std::runtime_error("Unable to initialize cipher.");
+    }
+
+    return ctx;
+  }
+
+  /// @brief Authenticates associated data. It must be added before the data is processed.
+  void UpdateAad(std::string_view aad) {
+    int out_length = 0;
+    if (aad.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())
+        || !EVP_CipherUpdate(ctx, nullptr, &out_length, reinterpret_cast<const unsigned char*>(aad.data()),
+                             static_cast<int>(aad.size()))) {
+      owner = 0;
+      throw std::runtime_error("Unable to process associated data.");
+    }
+  }
+
+  /// @brief Processes the data. It must not be interrupted, so the context is reset on failure.
+  void Update(const unsigned char* in, std::size_t size, unsigned char* out) {
+    // EVP_CipherUpdate takes int lengths, so huge values are processed in chunks
+    constexpr std::size_t kChunkSize {1u << 30};
+    for (std::size_t pos = 0; pos < size; pos += kChunkSize) {
+      const int chunk = static_cast<int>(std::min(kChunkSize, size - pos));
+      int out_length = 0;
+      if (!EVP_CipherUpdate(ctx, out + pos, &out_length, in + pos, chunk) || out_length != chunk) {
+        owner = 0;
+        throw std::runtime_error("Unable to process data. Unexpected result length.");
+      }
+    }
+  }
+
+  EVP_CIPHER_CTX* ctx;
+  /// @brief Identifier of the cipher the context is keyed for (0 - none)
+  uint64_t owner {0};
+};
+
+/// @brief Cipher contexts of the current thread
+struct ThreadCipherContexts {
+  ThreadCipherContext encrypt;
+  ThreadCipherContext decrypt;
+  ThreadCipherContext legacy_decrypt;
+};
+
+ThreadCipherContexts& GetThreadContexts() {
+  static thread_local ThreadCipherContexts contexts;
+
+  return contexts;
+}
+
+std::atomic<uint64_t> cipher_ids {0};
+} // namespace
+
+Cipher::Cipher(const std::string& secret) : id(++cipher_ids) {
+  const EVP_CIPHER *legacy = EVP_aes_256_cfb8();
+  if (EVP_CIPHER_key_length(legacy) != kKeySize || EVP_CIPHER_iv_length(legacy) != kIvSize
+      || EVP_CIPHER_key_length(EVP_aes_256_gcm()) != kKeySize) {
+    throw std::logic_error("Unexpected AES-256 key or IV length.");
+  }
+
+  // Creates a key of the specific length for the legacy cipher algorithm
+  create_key(
+      reinterpret_cast<const unsigned char*>(secret.c_str()), secret.length(),
+      legacy_key, kKeySize,
+      legacy_iv, kIvSize
+  );
+
+  // The GCM key is derived from the whole secret so it's independent from the legacy one
+  const std::string label {"bambooslacking aes-256-gcm"};
+  unsigned int key_length = 0;
+  HMAC(
+      EVP_sha256(),
+      secret.data(), secret.size(),
+      reinterpret_cast<const unsigned char*>(label.data()), label.size(),
+      key, &key_length
+  );
+  if (key_length != kKeySize) {
+    throw std::logic_error("Unexpected key length.");
+  }
+}
+
+Cipher::Format Cipher::GetFormat(std::string_view data) {
+  if (data.empty()) {
+    return kFormatLegacy;
+  }
+  const auto c = static_cast<uint8_t>(data[0]);
+  switch (c) {
+    case kFormatGcmBase64:
+      return kFormatGcmBase64;
+    case kFormatGcm:
+      return kFormatGcm;
+    case kFormatGcmAad:
+      return kFormatGcmAad;
+    default:
+      // Legacy values are base64 text
+      return c < 128 && reverse_table[c] < 64 ? kFormatLegacy : kFormatUnknown;
+  }
+}
+
+std::string Cipher::Encrypt(std::string_view data, std::string_view aad) const {
+  // version | nonce | ciphertext | tag. GCM is a stream mode, so the ciphertext is as long as the data.
+  std::string sealed(1 + kNonceSize + data.size() + kTagSize, '\0');
+  sealed[0] = static_cast<char>(kCurrentFormat);
+  auto nonce = reinterpret_cast<unsigned char*>(sealed.data()) + 1;
+  auto ciphertext = nonce + kNonceSize;
+  if (RAND_bytes(nonce, kNonceSize) != 1) {
+    throw std::runtime_error("Unable to generate nonce.");
+  }
+
+  auto& context = GetThreadContexts().encrypt;
+  auto ctx = context.Init(id, EVP_aes_256_gcm(), key, nonce, true);
+  context.UpdateAad(aad);
+  context.Update(reinterpret_cast<const unsigned char*>(data.data()), data.size(), ciphertext);
+  int f_len = 0;
+  if (!EVP_CipherFinal_ex(ctx, ciphertext + data.size(), &f_len)
+      || !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, kTagSize, ciphertext + data.size())) {
+    context.owner = 0;
+    throw std::runtime_error("Unable to encrypt string.");
+  }
+
+  return sealed;
+}
+
+std::string Cipher::Decrypt(const std::string& data, std::string_view aad) const {
+  if (GetFormat(data) != kCurrentFormat) {
+    throw std::runtime_error("Unable to decrypt string. The format is not accepted.");
+  }
+
+  return Open(std::string_view(data).substr(1), aad);
+}
+
+std::string Cipher::DecryptAnyFormat(const std::string& data, std::string_view aad, Format* format) const {
+  const auto f = GetFormat(data);
+  if (format != nullptr) {
+    *format = f;
+  }
+  switch (f) {
+    case kFormatGcmAad:
+      return Open(std::string_view(data).substr(1), aad);
+    case kFormatGcm:
+      return Open(std::string_view(data).substr(1), {});
+    case kFormatGcmBase64:
+      return Open(base64_decode(data.substr(1)), {});
+    case kFormatLegacy:
+      return DecryptLegacy(data);
+    default:
+      throw std::runtime_error("Unable to decrypt string. Unknown format.");
+  }
+}
+
+std::string Cipher::Open(std::string_view sealed, std::string_view aad) const {
+  if (sealed.size() < kNonceSize + kTagSize) {
+    throw std::runtime_error("Unable to decrypt string. The value is truncated.");
+  }
+  const std::size_t size = sealed.size() - kNonceSize - kTagSize;
+  auto nonce = reinterpret_cast<const unsigned char*>(sealed.data());
+  auto ciphertext = nonce + kNonceSize;
+  unsigned char tag[kTagSize];
+  std::memcpy(tag, ciphertext + size, kTagSize);
+
+  std::string dest(size, '\0');
+  auto out = reinterpret_cast<unsigned char*>(dest.data());
+  auto& context = GetThreadContexts().decrypt;
+  auto ctx = context.Init(id, EVP_aes_256_gcm(), key, nonce, false);
+  context.UpdateAad(aad);
+  context.Update(ciphertext, size, out);
+  int f_len = 0;
+  if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, kTagSize, tag) || EVP_CipherFinal_ex(ctx, out + size, &f_len) <= 0) {
+    context.owner = 0;
+    throw std::runtime_error("Unable to decrypt string. Authentication failed.");
+  }
+
+  return dest;
+}
+
+std::string Cipher::DecryptLegacy(const std::string& data) const {
+  std::string dest {base64_decode(data)};
+  auto buf = reinterpret_cast<unsigned char*>(dest.data());
+  auto& context = GetThreadContexts().legacy_decrypt;
+  context.Init(id, EVP_aes_256_cfb8(), legacy_key, legacy_iv, false);
+  // Decrypts in place
+  context.Update(buf, dest.size(), buf);
+
+  return dest;
+}
+
+std::vector<std::string> Cipher::Encrypt(
+    const std::vector<std::string>& data,
+    const std::vector<std::string>& aad
+) const {
+  if (aad.size() != data.size()) {
+    throw std::invalid_argument("Every value must have associated data.");
+  }
+  std::vector<std::string> ret;
+  ret.reserve(data.size());
+  for (std::size_t i = 0; i < data.size(); i++) {
+    ret.push_back(Encrypt(data[i], aad[i]));
+  }
+
+  return ret;
+}
+
+std::vector<std::string> Cipher::Decrypt(
+    const std::vector<std::string>& data,
+    const std::vector<std::string>& aad
+) const {
+  if (aad.size() != data.size()) {
+    throw std::invalid_argument("Every value must have associated data.");
+  }
+  std::vector<std::string> ret;
+  ret.reserve(data.size());
+  for (std::size_t i = 0; i < data.size(); i++) {
+    ret.push_back(Decrypt(data[i], aad[i]));
+  }
+
+  return ret;
+}
+
+std::string encrypt(const std::string& data, const std::string& secret) {
+  return Cipher(secret).Encrypt(data, {});
 }
 
-std::string decrypt(const std::string& data, const std::string& secret)
-{
-  const std::string b64decoded = base64_decode(data);
-  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-  const EVP_CIPHER *cipher = EVP_aes_256_cfb8();
-  uint8_t key_length = EVP_CIPHER_key_length(cipher);
-  uint8_t iv_length = EVP_CIPHER_iv_length(cipher);
-  int u_len, f_len;
-  unsigned char rkey[key_length];
-  unsigned char iv[iv_length];
-  unsigned char dest[b64decoded.size()];
-  memset(dest, 0, b64decoded.size());
-
-  // Creates a key of the specific length for this type of the cipher algorithm
-  create_key(reinterpret_cast<const unsigned char*>(secret.c_str()), secret.length(), rkey, key_length, iv, iv_length);
-
-  EVP_DecryptInit(ctx, cipher, rkey, iv);
-  EVP_CIPHER_CTX_set_padding(ctx, true);
-  EVP_DecryptUpdate(ctx, dest, &u_len, reinterpret_cast<const unsigned char*>(b64decoded.data()), b64decoded.size());
-  EVP_DecryptFinal_ex(ctx, dest + u_len, &f_len);
-  EVP_CIPHER_CTX_free(ctx);
-
-  std::stringstream ss;
-  for (int i = 0; i < (u_len + f_len); i++) {
-    ss << dest[i];
-  }
-
-  return ss.str();
+std::string decrypt(const std::string& data, const std::string& secret) {
+  return Cipher(secret).DecryptAnyFormat(data, {});
 }
-} // namespace bs
\ No newline at end of file
+} // namespace bs
@@ -0,0 +1,60 @@
+#include <chrono>
+#include "http_client_pool.h"
+
+using namespace web;
+using namespace web::http;
+
+namespace bs {
+std::shared_ptr<client::http_client> HttpClientPool::GetClient(const std::string& base_url, bool* is_new) {
+  const std::string key = uri(base_url).authority().to_string();
+  std::lock_guard<std::mutex> lock {mutex};
+
+  if (is_new != nullptr) {
+    *is_new = false;
+  }
+
+  if (auto it = clients.find(key); it != clients.end()) {
+    return it->second;
+  }
+
+  auto c = std::make_shared<client::http_client>(key);
+  clients[key] = c;
+  ++created;
+
+  if (is_new != nullptr) {
+    *is_new = true;
+  }
+
+  return c;
+}
+
+pplx::task<http_response> HttpClientPool::Request(const std::string& base_url, const http_request& req) {
+  bool is_new = false;
+  auto c = GetClient(base_url, &is_new);
+
+  ++requests;
+  if (!is_new) {
+    ++reused;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  // The client is captured to keep it alive until the response arrives
+  return c->request(req).then([this, c, start](pplx::task<http_response> t) {
+    latency_us += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    try {
+      return t.get();
+    } catch (...) {
+      ++failed;
+      throw;
+    }
+  });
+}
+
+HttpClientPool::Stats HttpClientPool::GetStats() const {
+  return {requests, reused, created, failed, latency_us};
+}
+} // namespace bs
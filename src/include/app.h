@@ -8,6 +8,7 @@
 #include <csignal>
 #include "slackapi.h"
 #include "bamboohrapi.h"
+#include "db.h"
 #include "easylogging++.h"
 #include "network_utils.h"
 
@@ -16,9 +17,24 @@ namespace bs {
 /// @brief Loads config. Returns TRUE on success
 bool LoadConfig();
 
-/// @brief Synchronizes BambooHR user's profile statuses with Slack user's status
+/// @brief Renders who-is-out slash command response
+/// @param message A who-is-out message. Empty message means nothing has been found.
+/// @returns Serialized JSON response
+std::string RenderWioResponse(const std::string& message);
+
+/// @brief Synchronizes BambooHR user's profile statuses with Slack user's status for a single team
+/// @param org The organization as it is returned by DB::GetOrgs
+/// @param batch A batch to add the team's who-is-out data and status snapshot to
+void SyncTeam(const Org& org, DB::Batch* batch);
+
+/// @brief Synchronizes BambooHR user's profile statuses with Slack user's status.
+/// Teams are processed concurrently by a bounded pool of workers (see Config::kSyncConcurrency).
 void SyncUserProfileStatuses();
 
+/// @brief Deletes install callbacks which are older than Config::kInstallCallbackTTL.
+/// Abandoned installations would be kept forever otherwise.
+void ReapInstallCallbacks();
+
 class RuntimeUtils {
  public:
   static void PrintStackTrace() {
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <cpprest/json.h>
+#include "common.h"
+
+namespace bs {
+/// @brief Gets the enabled users of the meta/users response. The response is read by reference,
+/// since it may be shared with the cache.
+/// @param response A response body
+/// @returns email => employeeId
+BambooHrUsersList ParseUsersList(const web::json::value& response);
+
+/// @brief Gets the days of the time_off/requests response which are within the period
+/// @param response A response body
+/// @param start_day The first day of the period (see strtodays)
+/// @param end_day The last day of the period
+BambooHrTimeOffList ParseTimeOffRequests(const web::json::value& response, int32_t start_day, int32_t end_day);
+} // namespace bs
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <stdexcept>
 #include <cpprest/http_client.h>
 #include "common.h"
@@ -16,10 +17,12 @@ class BambooHrApiClient {
   /// @param kOrgName BambooHR organization name is used as a part of API URL
   BambooHrApiClient(const std::string& kApiToken, const std::string& kOrgName);
 
-  /// @brief Sends API request
+  /// @brief Sends API request. GET responses are cached (see ResponseCache) and revalidated
+  /// with conditional requests once they are older than Config::kBambooHrCacheTTL.
   /// @param mtd HTTP method
   /// @param uri request URI
-  web::json::value SendRequest(const web::http::method& mtd, const std::string& uri);
+  /// @returns Parsed response body. It may be shared with the cache so it is immutable.
+  std::shared_ptr<const web::json::value> SendRequest(const web::http::method& mtd, const std::string& uri);
 
   /// @brief Gets the list of the Users
   BambooHrUsersList UsersList();
@@ -34,6 +37,8 @@ class BambooHrApiClient {
   const std::string kApiToken;
   ///@brief BambooHR organization name is the part of the API URL
   const std::string kOrgName;
+  ///@brief Authorization header value. It's encoded once as the token does not change.
+  const std::string kAuthorization;
 };
 
 /// @brief BambooHR API error
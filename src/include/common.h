@@ -4,8 +4,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
 #include <mutex>
-#include <regex>
+#include <string_view>
 
 namespace bs {
 /// @brief Templates directory
@@ -20,10 +21,84 @@ inline const std::string kLogFile {"/var/log/bambooslacking.log"};
 inline const std::string kDbName {"/opt/bambooslacking/db/bsdb"};
 /// @brief The name of the command
 inline const std::string kCommandName {"whoisout"};
-/// @brief An alphanumeric regular expression pattern
-inline const std::regex kRegexAlphanum {"[a-z0-9]+", std::regex::icase};
-/// @brief A word regular expression pattern
-inline const std::regex kRegexWord {"[a-z][a-z0-9_]+", std::regex::icase};
+
+/// @brief Checks whether the character is an ASCII letter
+constexpr bool IsAsciiAlpha(const char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/// @brief Checks whether the character is an ASCII digit
+constexpr bool IsAsciiDigit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+/// @brief Checks whether the character is a hexadecimal digit
+constexpr bool IsHexDigit(const char c) {
+  return IsAsciiDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+/// @brief Checks whether the string is a nonempty alphanumeric string. It is the same as [a-z0-9]+ (icase).
+constexpr bool IsAlphanum(std::string_view s) {
+  for (const char c : s) {
+    if (!IsAsciiAlpha(c) && !IsAsciiDigit(c)) {
+      return false;
+    }
+  }
+  return !s.empty();
+}
+
+/// @brief Checks whether the string is a word. It is the same as [a-z][a-z0-9_]+ (icase).
+constexpr bool IsWord(std::string_view s) {
+  if (s.size() < 2 || !IsAsciiAlpha(s[0])) {
+    return false;
+  }
+  for (const char c : s.substr(1)) {
+    if (!IsAsciiAlpha(c) && !IsAsciiDigit(c) && c != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief Checks whether the string is a Slack trigger identifier. It is the same as [a-z0-9_\.]+ (icase).
+constexpr bool IsTriggerId(std::string_view s) {
+  for (const char c : s) {
+    if (!IsAsciiAlpha(c) && !IsAsciiDigit(c) && c != '_' && c != '.') {
+      return false;
+    }
+  }
+  return !s.empty();
+}
+
+/// @brief Checks whether the string is a hexadecimal string of the minimum length. It is the same as [a-f0-9]{n,} (icase).
+constexpr bool IsHexString(std::string_view s, const std::size_t min_length) {
+  for (const char c : s) {
+    if (!IsHexDigit(c)) {
+      return false;
+    }
+  }
+  return s.size() >= min_length;
+}
+
+/// @brief Checks whether the string is a single-line HTTPS URL. It is the same as ^https://.+
+constexpr bool IsHttpsUrl(std::string_view s) {
+  constexpr std::string_view scheme {"https://"};
+  if (s.size() <= scheme.size() || s.substr(0, scheme.size()) != scheme) {
+    return false;
+  }
+  for (const char c : s.substr(scheme.size())) {
+    if (c == '\n' || c == '\r') {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(IsAlphanum("T0123abc") && !IsAlphanum("") && !IsAlphanum("T-1"));
+static_assert(IsWord("my_org1") && !IsWord("a") && !IsWord("1org"));
+static_assert(IsTriggerId("123.456_ab") && !IsTriggerId("") && !IsTriggerId("1/2"));
+static_assert(IsHexString("0aF9", 4) && !IsHexString("0aF", 4) && !IsHexString("0aFg", 4));
+static_assert(IsHttpsUrl("https://a") && !IsHttpsUrl("https://") && !IsHttpsUrl("http://a"));
 
 // Configuration options keys
 inline const std::string kCfgSlackClientID {"slack_client_id"};
@@ -35,6 +110,55 @@ inline const std::string kCfgSSLCert {"ssl_cert_pem"};
 inline const std::string kCfgSSLKey {"ssl_key_pem"};
 inline const std::string kCfgSSLFullchain {"ssl_fullchain_pem"};
 inline const std::string kCfgSSLContextPassword {"ssl_context_password"};
+inline const std::string kCfgSyncConcurrency {"sync_concurrency"};
+inline const std::string kCfgStatusUpdateConcurrency {"status_update_concurrency"};
+inline const std::string kCfgFullSyncInterval {"full_sync_interval"};
+inline const std::string kCfgBambooHrCacheTTL {"bamboohr_cache_ttl"};
+inline const std::string kCfgBambooHrCachePersistent {"bamboohr_cache_persistent"};
+inline const std::string kCfgDbSync {"db_sync"};
+inline const std::string kCfgDbBackend {"db_backend"};
+inline const std::string kCfgDbPath {"db_path"};
+inline const std::string kCfgInstallCallbackTTL {"install_callback_ttl"};
+inline const std::string kCfgDbBlockCacheSize {"db_block_cache_size"};
+inline const std::string kCfgDbBloomFilterBits {"db_bloom_filter_bits"};
+inline const std::string kCfgDbCompression {"db_compression"};
+inline const std::string kCfgDbWriteBufferSize {"db_write_buffer_size"};
+
+/// @brief How many teams are synchronized concurrently if it is not set in config
+constexpr unsigned int kDefaultSyncConcurrency {4};
+/// @brief How many profile status updates may be in flight per team if it is not set in config
+constexpr unsigned int kDefaultStatusUpdateConcurrency {16};
+/// @brief How often (seconds) statuses are reconciled with Slack if it is not set in config
+constexpr unsigned int kDefaultFullSyncInterval {21600};
+/// @brief How long (seconds) BambooHR responses are used without revalidation if it is not set in config
+constexpr unsigned int kDefaultBambooHrCacheTTL {1800};
+/// @brief How long (seconds) an install command waits for the permissions to be granted if it is not set in config
+constexpr unsigned int kDefaultInstallCallbackTTL {3600};
+/// @brief How often (seconds) expired install callbacks are deleted
+constexpr unsigned int kInstallCallbackReapInterval {300};
+/// @brief Database block cache size (bytes) if it is not set in config
+constexpr uint64_t kDefaultDbBlockCacheSize {8 << 20};
+/// @brief Bits per key of the database bloom filter if it is not set in config
+constexpr unsigned int kDefaultDbBloomFilterBits {10};
+/// @brief Database write buffer size (bytes) if it is not set in config
+constexpr uint64_t kDefaultDbWriteBufferSize {4 << 20};
+
+/// @brief Durability modes of database writes
+enum DbSyncMode : uint8_t {
+  /// @brief Writes are left to the OS to flush. A machine crash may lose the latest ones.
+  kDbSyncNone,
+  /// @brief Batches of a sync pass are flushed to disk, single writes are not
+  kDbSyncBatch,
+  /// @brief Every write is flushed to disk
+  kDbSyncAlways
+};
+
+/// @brief Config values of the durability modes
+inline const std::map<std::string, DbSyncMode> kDbSyncModes {
+    {"none", kDbSyncNone},
+    {"batch", kDbSyncBatch},
+    {"always", kDbSyncAlways}
+};
 
 /// @brief text/html; charset=utf-8 string that is used in ContentType header
 inline const std::string kContentTypeTextHTMLCharsetUTF8 {"text/html; charset=utf-8"};
@@ -67,10 +191,67 @@ struct UserProfile {
 
 // email, employee_id
 typedef std::map<std::string, int> BambooHrUsersList;
-// employee_id => [date => time-off name[]]
-typedef std::map<int, std::map<std::string, std::vector<std::string>>> BambooHrTimeOffList;
-/// email, user_profile
-typedef std::map<std::string, UserProfile> SlackUsersList;
+/// @brief Approved time-offs of BambooHR employees.
+/// Entries are kept in a flat vector sorted by employee and day, and time-off type names are interned,
+/// so looking up an employee's day is a binary search over a contiguous array.
+class BambooHrTimeOffList {
+ public:
+  /// @brief A time-off of an employee for a single day
+  struct Entry {
+    /// @brief BambooHR employeeId
+    int employee_id;
+    /// @brief Days since the unix epoch (see strtodays)
+    int32_t day;
+    /// @brief Interned time-off type name (see TypeName)
+    uint16_t type;
+  };
+
+  typedef std::vector<Entry>::const_iterator const_iterator;
+
+  /// @brief Adds a time-off. Sort must be called once all time-offs are added.
+  /// @param employee_id BambooHR employeeId
+  /// @param day Days since the unix epoch
+  /// @param type_name A name of the time-off type
+  void Add(int employee_id, int32_t day, const std::string& type_name);
+
+  /// @brief Sorts time-offs and removes duplicates
+  void Sort();
+
+  /// @brief Gets all time-offs of the employee for the day
+  /// @param employee_id BambooHR employeeId
+  /// @param day Days since the unix epoch
+  /// @returns A range of entries which is empty if there is no time-off
+  std::pair<const_iterator, const_iterator> Find(int employee_id, int32_t day) const;
+
+  /// @brief Gets the time-off type of the employee for the day.
+  /// If there are several time-offs for the day, the first one by name is chosen.
+  /// @param employee_id BambooHR employeeId
+  /// @param day Days since the unix epoch
+  /// @returns nullptr if there is no time-off
+  const std::string* FindType(int employee_id, int32_t day) const;
+
+  /// @brief Gets a name of the interned time-off type
+  const std::string& TypeName(uint16_t type) const {
+    return type_names[type];
+  }
+
+  std::size_t size() const {
+    return entries.size();
+  }
+
+  bool empty() const {
+    return entries.empty();
+  }
+
+ private:
+  std::vector<Entry> entries;
+  /// @brief type => name
+  std::vector<std::string> type_names;
+  /// @brief name => type
+  std::map<std::string, uint16_t> type_ids;
+};
+/// Slack users in the order they are returned by Slack. Emails are unique.
+typedef std::vector<UserProfile> SlackUsersList;
 
 struct Config {
   /// @brief Slack application client ID issued on app creation
@@ -91,6 +272,32 @@ struct Config {
   std::string kSSLChainFile;
   /// @brief Context password for SSL certificate
   std::string kSSLContextPassword;
+  /// @brief The maximum number of teams that are synchronized concurrently
+  unsigned int kSyncConcurrency;
+  /// @brief The maximum number of profile status updates that are in flight per team
+  unsigned int kStatusUpdateConcurrency;
+  /// @brief How often (seconds) the users list and their actual statuses are fetched from Slack
+  unsigned int kFullSyncInterval;
+  /// @brief How long (seconds) BambooHR responses are used without revalidation
+  unsigned int kBambooHrCacheTTL;
+  /// @brief Whether cached BambooHR responses are stored to database
+  bool kBambooHrCachePersistent;
+  /// @brief When database writes are flushed to disk
+  DbSyncMode kDbSync;
+  /// @brief Storage backend of the database: leveldb, memory or rocksdb
+  std::string kDbBackend;
+  /// @brief Database directory
+  std::string kDbPath;
+  /// @brief How long (seconds) install callbacks are kept
+  unsigned int kInstallCallbackTTL;
+  /// @brief Database block cache size (bytes)
+  uint64_t kDbBlockCacheSize;
+  /// @brief Bits per key of the database bloom filter, 0 disables it
+  unsigned int kDbBloomFilterBits;
+  /// @brief Whether database blocks are compressed with Snappy
+  bool kDbCompression;
+  /// @brief Database write buffer size (bytes)
+  uint64_t kDbWriteBufferSize;
 };
 
 /// @brief Application config is initializes once on load
@@ -110,4 +317,12 @@ std::string GetCurrentTimestamp(const char* fmt, const long& offset);
 /// @brief Gets unix time from the "YYYY-MM-DD HH:MM:SS" timestamp.
 /// @param s a timestamp is expected to be provided in the UTC time zone.
 uint64_t strtotime(const std::string& s);
+
+/// @brief Gets the number of days since the unix epoch from the "YYYY-MM-DD" date.
+/// @param s a date
+int32_t strtodays(const std::string& s);
+
+/// @brief Gets the number of days since the unix epoch for the current date (in UTC timezone)
+/// @param offset offset in seconds
+int32_t GetCurrentDay(const long& offset);
 } // namespace bs
\ No newline at end of file
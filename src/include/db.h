@@ -1,15 +1,40 @@
 #pragma once
 
-#include <leveldb/db.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <cpprest/json.h>
 #include "common.h"
+#include "encryption.h"
+#include "org_registry.h"
+#include "records.h"
+#include "storage.h"
 
 namespace bs {
 /// @brief DB operations
 class DB {
  public:
   static DB& GetInstance() {
-    static DB instance {app_config.kCryptokey};
+    static DB instance {
+        app_config.kCryptokey,
+        app_config.kDbSync,
+        app_config.kInstallCallbackTTL,
+        OpenStorage(
+            app_config.kDbBackend,
+            app_config.kDbPath,
+            {
+                app_config.kDbBlockCacheSize,
+                static_cast<int>(app_config.kDbBloomFilterBits),
+                app_config.kDbCompression,
+                app_config.kDbWriteBufferSize,
+                {
+                    kTeamPrefix, kUserPrefix, kWhoIsOutPrefix, kCallbackPrefix, kCallbackIndexPrefix,
+                    kStatusPrefix, kResponseCachePrefix, kMetaPrefix
+                }
+            }
+        )
+    };
     // Instantiated on first use.
     return instance;
   }
@@ -20,11 +45,37 @@ class DB {
   inline static const std::string kUserPrefix = "USER";
   inline static const std::string kWhoIsOutPrefix = "WIO";
   inline static const std::string kCallbackPrefix = "CALLBACK";
+  /// @brief Install callbacks time index: CBTIME:<zero-padded unix time>:<trigger ID>
+  inline static const std::string kCallbackIndexPrefix = "CBTIME";
+  inline static const std::string kStatusPrefix = "STATUS";
+  inline static const std::string kResponseCachePrefix = "HTTPCACHE";
+  inline static const std::string kMetaPrefix = "META";
 
-  /// @brief Gets all organization to process who is out
-  /// @param res A map where key is slack team ID and value is json object that contain organization metadata
+  /// @brief The version of the record storage format: 1 - base64 text values, 2 - binary values,
+  /// 3 - binary encoded organizations, tokens and callbacks instead of JSON, 4 - install callbacks are indexed by time,
+  /// 5 - values are bound to their record keys,
+  /// 6 - who-is-out records hold rendered responses instead of messages
+  static constexpr unsigned int kStorageFormatVersion {6};
+
+  /// @brief Converts all records to the current storage format unless it has been done already.
+  /// Database is compacted afterwards to reclaim the space taken by the old values.
+  /// Records which can not be decrypted are left as is, so they are never re-sealed as authenticated garbage.
+  /// @param migrated The number of converted records to set
+  /// @param failed The number of records which could not be decrypted to set
+  /// @returns TRUE on success or FALSE if the converted records could not be written
+  bool MigrateStorage(uint64_t* migrated, uint64_t* failed);
+
+  /// @brief Gets all organization to process who is out. They are served from memory.
+  /// @param res Organizations with their admin tokens ordered by Slack team ID
   /// @returns TRUE on success or FALSE otherwise
-  bool GetOrgs(std::map<std::string, web::json::value>* res);
+  bool GetOrgs(std::vector<Org>* res);
+
+  /// @brief Gets user's Slack access token. It is served from memory.
+  /// @param slack_team_id Slack team ID
+  /// @param slack_user_id Slack user ID
+  /// @param res The token to set
+  /// @returns TRUE on success or FALSE if there is no token
+  bool GetAccessToken(const std::string& slack_team_id, const std::string& slack_user_id, std::string* res);
 
   /// @brief Add new or replace existing organization
   /// @param bamboo_hr_org An organization name as it's used in the API url
@@ -43,78 +94,242 @@ class DB {
   /// @param slack_user_id Slack user ID
   /// @param res A token
   /// @returns TRUE on success or FALSE otherwise
-  bool GetUserToken(const std::string& slack_team_id, const std::string& slack_user_id, web::json::value* res);
-
-  /// @brief Puts user's token
-  /// @param slack_team_id Slack team ID
-  /// @param slack_user_id Slack user ID
-  /// @param token JSON string
-  /// @returns Returns TRUE on success or FALSE on failure
-  bool PutUserToken(const std::string& slack_team_id, const std::string& slack_user_id, const std::string& token);
+  bool GetUserToken(const std::string& slack_team_id, const std::string& slack_user_id, UserToken* res);
 
   /// @brief Puts user's token
   /// @param slack_team_id Slack team ID
   /// @param slack_user_id Slack user ID
   /// @param token A token
   /// @returns Returns TRUE on success or FALSE on failure
-  bool PutUserToken(
-      const std::string& slack_team_id,
-      const std::string& slack_user_id,
-      const web::json::value& token
-  ) {
-    return PutUserToken(slack_team_id, slack_user_id, token.serialize());
-  }
+  bool PutUserToken(const std::string& slack_team_id, const std::string& slack_user_id, const UserToken& token);
 
   /// @brief Puts install callback to handle in future
   /// @param trigger_id A Slack API action's trigger identifier
-  /// @param data object with all necessary parameters to complete install action
+  /// @param data All necessary parameters to complete install action
   /// @returns TRUE on success or FALSE otherwise
-  bool PutInstallCallback(
-    const std::string& trigger_id,
-    const web::json::value& data
-  );
+  bool PutInstallCallback(const std::string& trigger_id, const InstallCallback& data);
 
-  /// @brief Gets install callback to proceed
+  /// @brief Gets install callback to proceed. A callback which has expired is not returned,
+  /// even if the reaper has not deleted it yet.
   /// @param trigger_id A Slack API action's trigger identifier
   /// @param res An output data object to set
   /// @returns TRUE on success or FALSE otherwise
-  bool GetInstallCallback(const std::string& trigger_id, web::json::value* res);
+  bool GetInstallCallback(const std::string& trigger_id, InstallCallback* res);
 
   /// @brief Deletes install callback from database
   /// @param trigger_id A Slack API action's trigger identifier
   /// @returns TRUE on success or FALSE otherwise
   bool DeleteInstallCallback(const std::string& trigger_id);
 
-  /// @brief Saves who-is-out message to database
+  /// @brief Deletes install callbacks which have been created before the time.
+  /// They are found by the time index, so the other callbacks are not read.
+  /// @param created_before Unix time
+  /// @param expired The number of deleted callbacks to set
+  /// @returns TRUE on success or FALSE otherwise
+  bool ExpireInstallCallbacks(int64_t created_before, uint64_t* expired);
+
+  /// @brief Gets a property of the storage backend, e.g. kStoragePropertyStats
+  /// @param name A property name
+  /// @param res A value to set
+  /// @returns TRUE on success or FALSE if the property is not supported
+  bool GetStorageProperty(const std::string& name, std::string* res) {
+    return db->GetProperty(name, res);
+  }
+
+  /// @brief Gets the number of install callbacks which have been deleted as expired
+  uint64_t GetExpiredCallbacks() const {
+    return expired_callbacks;
+  }
+
+  /// @brief Saves who-is-out slash command response body to database
+  /// @param slack_team_id A Slack team ID
+  /// @param response A response body. It is stored as is.
+  /// @returns Returns TRUE on success or FALSE on failure
+  bool PutWioResponse(const std::string& slack_team_id, const std::string& response);
+
+  /// @brief Gets who-is-out slash command response body. It is rendered by the sync, so it is ready to be sent as is.
+  /// Responses are cached in memory once they have been read from database. So is a missing response,
+  /// but not a failed read, which is retried next time.
+  /// @param slack_team_id A Slack team ID
+  /// @param response A response body to set. It is empty if there is no response for the team.
+  /// @returns Returns TRUE on success or FALSE if the response can not be read
+  bool GetWioResponse(const std::string& slack_team_id, std::string* response);
+
+  /// @brief Who-is-out responses cache metrics
+  struct WioCacheStats {
+    /// @brief The number of responses served from memory
+    uint64_t hits;
+    /// @brief The number of messages read from database
+    uint64_t misses;
+  };
+
+  /// @brief Gets a snapshot of who-is-out messages cache metrics
+  WioCacheStats GetWioCacheStats() const {
+    return {wio_cache_hits, wio_cache_misses};
+  }
+
+  /// @brief Saves a snapshot of the team's users with the profile statuses that have been applied last time
   /// @param slack_team_id A Slack team ID
-  /// @param message A message
+  /// @param users Slack users who exist in BambooHR
+  /// @param reconciled_at Unix time when the snapshot was refreshed from Slack last time
   /// @returns Returns TRUE on success or FALSE on failure
-  bool PutWioData(const std::string& slack_team_id, const std::string& message);
+  bool PutStatusSnapshot(const std::string& slack_team_id, const SlackUsersList& users, const uint64_t& reconciled_at);
 
-  /// @brief Gets who-is-out message from database
+  /// @brief Gets a snapshot of the team's users with the profile statuses that have been applied last time
   /// @param slack_team_id A Slack team ID
-  /// @returns Returns a message on success or empty string otherwise
-  std::string GetWioData(const std::string& slack_team_id);
+  /// @param users Slack users who exist in BambooHR
+  /// @param reconciled_at Unix time when the snapshot was refreshed from Slack last time
+  /// @returns TRUE on success or FALSE if there is no snapshot
+  bool GetStatusSnapshot(const std::string& slack_team_id, SlackUsersList* users, uint64_t* reconciled_at);
+
+  /// @brief Saves cached API response
+  /// @param key A cache key
+  /// @param data Serialized cache entry
+  /// @returns Returns TRUE on success or FALSE on failure
+  bool PutResponseCache(const std::string& key, const std::string& data);
+
+  /// @brief Gets cached API response
+  /// @param key A cache key
+  /// @param res Serialized cache entry
+  /// @returns TRUE on success or FALSE if it does not exist
+  bool GetResponseCache(const std::string& key, std::string* res);
+
+  /// @brief Deletes cached API response
+  /// @param key A cache key
+  /// @returns Returns TRUE on success or FALSE on failure
+  bool DeleteResponseCache(const std::string& key);
+
+  /// @brief Gets the number of records which have been re-encrypted from the legacy format
+  uint64_t GetMigratedRecords() const {
+    return migrated_records;
+  }
+
+  /// @brief Records which are committed at once (see Write)
+  class Batch;
+
+  /// @brief Commits all records of the batch in a single atomic write
+  /// @param batch A batch. It is cleared on success.
+  /// @returns Returns TRUE on success or FALSE on failure
+  bool Write(Batch* batch);
+
+  /// @brief Gets metrics of the last sync pass
+  /// @param res Metrics object to set
+  /// @returns TRUE on success or FALSE if there are no metrics
+  bool GetSyncStats(web::json::value* res);
 
  protected:
-  /// @brief leveldb database instance
-  leveldb::DB* db;
-  /// @brief leveldb database options
-  leveldb::Options options;
-  /// @brief cryptokey
-  std::string kCryptokey;
+  /// @brief Storage backend which keeps the records
+  std::unique_ptr<Storage> db;
+  /// @brief Cipher bound to the cryptokey
+  const Cipher cipher;
+  /// @brief Serializes writes so that lazy migration never overwrites a newer value
+  std::mutex write_mutex;
+  std::atomic<uint64_t> migrated_records {0};
+  /// @brief Whether records of the former formats may still exist (see MigrateStorage)
+  std::atomic<bool> migration_pending {true};
+  std::atomic<uint64_t> expired_callbacks {0};
+
+  /// @brief Encrypts and saves a record
+  /// @param key A record key
+  /// @param data A plain value
+  /// @returns Returns TRUE on success or FALSE on failure
+  bool PutRecord(const std::string& key, const std::string& data);
+
+  /// @brief Decrypts a record. The former formats are accepted only until the storage has been migrated.
+  /// @param key A record key
+  /// @param value An encrypted value
+  /// @param format The format of the value to set (optional)
+  /// @returns Returns decrypted value
+  std::string OpenRecord(const std::string& key, const std::string& value, Cipher::Format* format = nullptr);
+
+  /// @brief Decrypts a record read from database. Records in the legacy format are re-encrypted.
+  /// @param key A record key
+  /// @param value An encrypted value
+  /// @returns Returns decrypted value
+  std::string DecryptRecord(const std::string& key, const std::string& value);
+
+  /// @brief Re-encrypts a legacy record unless it has been changed in the meantime
+  /// @param key A record key
+  /// @param value The encrypted value which has been read
+  /// @param data The decrypted value
+  void MigrateRecord(const std::string& key, const std::string& value, const std::string& data);
+
+  /// @brief Checks whether a write is flushed to disk in the configured durability mode
+  /// @param batch Whether the write is a batch
+  bool IsSyncWrite(bool batch) const {
+    return sync_mode == kDbSyncAlways || (batch && sync_mode == kDbSyncBatch);
+  }
+
+  /// @brief When writes are flushed to disk
+  const DbSyncMode sync_mode;
+
+  /// @brief How long (seconds) an install callback may be completed
+  const unsigned int callback_ttl;
+
+  /// @brief Organizations and user tokens
+  OrgRegistry orgs;
+
+  /// @brief Fills the organization registry from database
+  void LoadOrgs();
+
+  /// @brief Cached who-is-out response of a team. Null means the team has no response in database.
+  using WioCacheEntry = std::shared_ptr<const std::string>;
+
+  /// @brief Slack team ID => who-is-out response
+  std::map<std::string, WioCacheEntry> wio_cache;
+  /// @brief Guards wio_cache
+  mutable std::shared_mutex wio_cache_mutex;
+  std::atomic<uint64_t> wio_cache_hits {0};
+  std::atomic<uint64_t> wio_cache_misses {0};
  private:
-  DB(const std::string& cryptokey) {
-    kCryptokey = cryptokey;
-    options.create_if_missing = true;
-    leveldb::Status status = leveldb::DB::Open(options, kDbName, &db);
-    if (!status.ok()) {
-      throw std::runtime_error("Could not connect to database " + kDbName);
-    }
+  DB(const std::string& cryptokey, const DbSyncMode sync_mode, const unsigned int callback_ttl,
+     std::unique_ptr<Storage> storage)
+      : db(std::move(storage)), cipher(cryptokey), sync_mode(sync_mode), callback_ttl(callback_ttl) {
+    std::string version;
+    migration_pending = !db->Get(kMetaPrefix + ":format", &version) || version != std::to_string(kStorageFormatVersion);
+    LoadOrgs();
   }
+};
+
+class DB::Batch {
+ public:
+  explicit Batch(DB& db) : db(db) {}
+
+  Batch(const Batch&) = delete;
+  Batch& operator=(const Batch&) = delete;
+
+  /// @brief Adds who-is-out slash command response body. The cache is updated once the batch is written.
+  /// @param slack_team_id A Slack team ID
+  /// @param response A response body. It is stored as is.
+  void PutWioResponse(const std::string& slack_team_id, const std::string& response);
 
-  ~DB() {
-    delete db;
+  /// @brief Adds a snapshot of the team's users with the profile statuses that have been applied last time
+  /// @param slack_team_id A Slack team ID
+  /// @param users Slack users who exist in BambooHR
+  /// @param reconciled_at Unix time when the snapshot was refreshed from Slack last time
+  void PutStatusSnapshot(const std::string& slack_team_id, const SlackUsersList& users, const uint64_t& reconciled_at);
+
+  /// @brief Adds metrics of the sync pass. They do not contain secrets, so they are stored as plain JSON.
+  /// @param stats Metrics object
+  void PutSyncStats(const web::json::value& stats);
+
+  /// @brief Gets the number of records in the batch
+  std::size_t size() const {
+    std::lock_guard<std::mutex> lock {mutex};
+    return batch.size();
   }
+
+ private:
+  friend class DB;
+
+  /// @brief Adds an encrypted record
+  void Put(const std::string& key, const std::string& value);
+
+  DB& db;
+  /// @brief Teams are synchronized concurrently, so records may be added from multiple threads
+  mutable std::mutex mutex;
+  StorageBatch batch;
+  /// @brief Who-is-out cache entries which are published after the batch is written
+  std::map<std::string, WioCacheEntry> wio_updates;
 };
 } // namespace bs
\ No newline at end of file
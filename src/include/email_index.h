@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "common.h"
+
+namespace bs {
+/// @brief Case-insensitive email => BambooHR employeeId index which joins Slack members to employees.
+/// Normalized emails are interned into a single buffer and looked up in an open addressing table
+/// with linear probing, so a lookup neither allocates nor follows tree pointers.
+class EmailIndex {
+ public:
+  /// @brief Builds the index
+  /// @param users BambooHR employees
+  explicit EmailIndex(const BambooHrUsersList& users);
+
+  /// @brief Finds an employee by email
+  /// @param email An email in any case
+  /// @param employee_id BambooHR employeeId to set
+  /// @returns TRUE if the employee has been found
+  bool Find(std::string_view email, int* employee_id) const;
+
+  std::size_t size() const {
+    return count;
+  }
+
+ private:
+  struct Slot {
+    /// @brief Hash of the normalized email
+    uint64_t hash;
+    /// @brief Offset of the normalized email in the pool
+    uint32_t offset;
+    /// @brief Length of the normalized email. Zero means an empty slot.
+    uint32_t length;
+    /// @brief BambooHR employeeId
+    int employee_id;
+  };
+
+  /// @brief FNV-1a hash of the lower case representation of the string
+  static uint64_t Hash(std::string_view s);
+
+  /// @brief ASCII lower case. Emails are compared case-insensitively only in their ASCII part.
+  static char Lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+  }
+
+  /// @brief Concatenated normalized emails
+  std::string pool;
+  /// @brief Open addressing table. Its size is a power of two.
+  std::vector<Slot> slots;
+  /// @brief The number of emails in the index
+  std::size_t count;
+};
+} // namespace bs
@@ -1,26 +1,129 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace bs {
+/// @brief Encodes binary data as a lowercase hexadecimal string
+/// @param data A data to encode
+/// @param size A length of the data
+std::string to_hex(const unsigned char* data, std::size_t size);
+
 /// @brief Calculates HMAC_SHA256 hash
 /// @param data A data to hash
 /// @param key A key
 /// @returns hash as a string
 std::string hmac_sha256(const std::string& data, const std::string& key);
 
-/// @brief Encrypts data using AES_cfb8_encrypt algorithm
+/// @brief Encrypts data into the Cipher envelope
 /// @param data A string to encrypt
 /// @param key A secret key. The size must be 32 characters or more
-/// @returns Returns base64 encoded encrypted string
+/// @returns Returns encrypted string
 std::string encrypt(const std::string& data, const std::string& key);
 
-/// @brief Decrypts data using AES_cfb8_encrypt algorithm
-/// @param data An base64 encoded binary string to decrypt
+/// @brief Decrypts data encrypted by the Cipher envelope or the legacy AES_cfb8_encrypt algorithm
+/// @param data An encrypted string to decrypt
 /// @param key A secret key. The size must be 32 characters or more
 /// @returns Returns decrypted value
 std::string decrypt(const std::string& data, const std::string& key);
 
+/// @brief Cipher for stored values bound to a secret key.
+///
+/// Values are sealed into a versioned envelope: a format version byte followed by the AES-256-GCM nonce,
+/// ciphertext and authentication tag. Every value gets its own random nonce. The envelope is binary.
+/// A value is bound to associated data, such as its record key, so it can not be moved to another record.
+/// Version bytes are never base64 characters, so values written in the former base64 formats
+/// (including the AES-256-CFB8 scheme without a version byte) are still recognized. They are decrypted
+/// by DecryptAnyFormat only, which lets callers migrate them. The legacy scheme is not authenticated,
+/// so Decrypt accepts the current format alone.
+///
+/// Keys are derived once, and every thread keeps its own cipher contexts which are only re-initialized
+/// with the IV for the next value. It's safe to use the same object from multiple threads.
+class Cipher {
+ public:
+  /// @brief Envelope format versions
+  enum Format : uint8_t {
+    /// @brief Legacy AES-256-CFB8 with the key-derived IV, base64 encoded and without a version byte
+    kFormatLegacy = 0,
+    /// @brief AES-256-GCM, base64 encoded
+    kFormatGcmBase64 = 1,
+    /// @brief AES-256-GCM, binary
+    kFormatGcm = 2,
+    /// @brief AES-256-GCM, binary, authenticated along with the associated data
+    kFormatGcmAad = 3,
+    /// @brief Not a known format. Such values are never decrypted.
+    kFormatUnknown = 0xff
+  };
+
+  /// @brief The format of the values that are encrypted now
+  static constexpr Format kCurrentFormat {kFormatGcmAad};
+
+  /// @brief The length of the GCM nonce
+  static constexpr std::size_t kNonceSize {12};
+  /// @brief The length of the GCM authentication tag
+  static constexpr std::size_t kTagSize {16};
+
+  /// @param secret A secret key. The size must be 32 characters or more
+  explicit Cipher(const std::string& secret);
+
+  /// @brief Encrypts data into the current envelope format
+  /// @param data A value to encrypt
+  /// @param aad Associated data the value is bound to, e.g. its record key
+  std::string Encrypt(std::string_view data, std::string_view aad) const;
+
+  /// @brief Decrypts a value of the current format
+  /// @param data An encrypted value
+  /// @param aad Associated data the value has been encrypted with
+  /// @returns Returns decrypted value
+  /// @throws std::runtime_error if the value has been tampered with or has another format
+  std::string Decrypt(const std::string& data, std::string_view aad) const;
+
+  /// @brief Decrypts a value of any known format. It's meant for migrating the values of the former formats.
+  /// @param data An encrypted value
+  /// @param aad Associated data the value has been encrypted with. The former formats do not use it.
+  /// @param format The format of the value to set (optional)
+  /// @returns Returns decrypted value
+  /// @throws std::runtime_error if the value has been tampered with or has an unknown format
+  std::string DecryptAnyFormat(const std::string& data, std::string_view aad, Format* format = nullptr) const;
+
+  /// @brief Encrypts multiple values at once
+  /// @param data Values to encrypt
+  /// @param aad Associated data of every value
+  std::vector<std::string> Encrypt(const std::vector<std::string>& data, const std::vector<std::string>& aad) const;
+
+  /// @brief Decrypts multiple values of the current format at once
+  /// @param data Encrypted values
+  /// @param aad Associated data of every value
+  std::vector<std::string> Decrypt(const std::vector<std::string>& data, const std::vector<std::string>& aad) const;
+
+  /// @brief Detects the format of an encrypted value
+  static Format GetFormat(std::string_view data);
+
+ private:
+  /// @brief Decrypts the binary AES-256-GCM nonce, ciphertext and tag
+  /// @param sealed Nonce, ciphertext and tag
+  /// @param aad Associated data. It's empty for the formats which do not use it.
+  std::string Open(std::string_view sealed, std::string_view aad) const;
+
+  /// @brief Decrypts the legacy AES-256-CFB8 value
+  std::string DecryptLegacy(const std::string& data) const;
+
+  static constexpr std::size_t kKeySize {32};
+  static constexpr std::size_t kIvSize {16};
+
+  /// @brief Unique identifier that tells thread contexts which cipher they are initialized for
+  const uint64_t id;
+  /// @brief AES-256-GCM key
+  unsigned char key[kKeySize];
+  /// @brief Legacy AES-256-CFB8 key
+  unsigned char legacy_key[kKeySize];
+  /// @brief Legacy AES-256-CFB8 IV
+  unsigned char legacy_iv[kIvSize];
+};
+
 /// @brief helper function that creates a real key for using in encryption
 /// @param key An original key string
 /// @param key_length A length of the original key
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cpprest/http_client.h>
+
+namespace bs {
+/// @brief Process-wide pool of keep-alive HTTP clients keyed by scheme and host.
+/// Every http_client keeps its own pool of persistent connections, so sharing one instance per host
+/// lets API clients reuse established TCP/TLS connections instead of doing a new handshake per request.
+class HttpClientPool {
+ public:
+  /// @brief Pool usage metrics
+  struct Stats {
+    /// @brief The number of requests sent through the pool
+    uint64_t requests;
+    /// @brief The number of requests that have been sent by an already existing client
+    uint64_t reused;
+    /// @brief The number of clients created. Each of them had to establish a new connection.
+    uint64_t created;
+    /// @brief The number of requests that failed on the transport level
+    uint64_t failed;
+    /// @brief Total time spent waiting for responses (microseconds)
+    uint64_t latency_us;
+  };
+
+  static HttpClientPool& GetInstance() {
+    static HttpClientPool instance;
+    // Instantiated on first use.
+    return instance;
+  }
+  HttpClientPool(HttpClientPool const&) = delete;
+  void operator=(HttpClientPool const&) = delete;
+
+  /// @brief Gets a shared client for the host of the specified URL, creating it if necessary
+  /// @param base_url An URL of the API, only its scheme and authority are taken into account
+  /// @param is_new Is set to TRUE if the client has been created by this call
+  std::shared_ptr<web::http::client::http_client> GetClient(const std::string& base_url, bool* is_new = nullptr);
+
+  /// @brief Sends a request using the shared client for the host of the specified URL
+  /// @param base_url An URL of the API, only its scheme and authority are taken into account
+  /// @param req A request to send
+  /// @returns A task that is completed once the response headers have been received
+  pplx::task<web::http::http_response> Request(const std::string& base_url, const web::http::http_request& req);
+
+  /// @brief Gets a snapshot of the pool metrics
+  Stats GetStats() const;
+
+ private:
+  HttpClientPool() {}
+
+  /// @brief Guards the clients map
+  mutable std::mutex mutex;
+  /// @brief scheme://host:port => client
+  std::map<std::string, std::shared_ptr<web::http::client::http_client>> clients;
+
+  std::atomic<uint64_t> requests {0};
+  std::atomic<uint64_t> reused {0};
+  std::atomic<uint64_t> created {0};
+  std::atomic<uint64_t> failed {0};
+  std::atomic<uint64_t> latency_us {0};
+};
+} // namespace bs
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace bs {
+/// @brief Forward-only JSON pull reader.
+/// It lets API clients pick the fields they need right from the response body without building a DOM.
+///
+/// Objects are read as:
+/// @code
+/// reader.BeginObject();
+/// while (reader.NextKey(&key)) {
+///   if (key == "id") id = reader.ReadString(); else reader.Skip();
+/// }
+/// @endcode
+class JsonReader {
+ public:
+  /// @param input JSON text. It must outlive the reader.
+  explicit JsonReader(std::string_view input) : input(input), pos(0), opened(false) {}
+
+  /// @brief Consumes the beginning of an object
+  void BeginObject() {
+    Expect('{');
+    opened = true;
+  }
+
+  /// @brief Reads the key of the next object member
+  /// @param key The key to set
+  /// @returns FALSE if the end of the object has been reached
+  bool NextKey(std::string* key);
+
+  /// @brief Consumes the beginning of an array
+  void BeginArray() {
+    Expect('[');
+    opened = true;
+  }
+
+  /// @brief Moves to the next array element
+  /// @returns FALSE if the end of the array has been reached
+  bool NextElement();
+
+  /// @brief Checks whether the next value is null and consumes it if so
+  bool ReadNull();
+
+  /// @brief Reads a string value
+  std::string ReadString();
+
+  /// @brief Reads a string value. Null is read as an empty string.
+  std::string ReadStringOrNull() {
+    return ReadNull() ? std::string() : ReadString();
+  }
+
+  /// @brief Reads a number value. The fractional part and exponent are ignored.
+  int64_t ReadInteger();
+
+  /// @brief Reads a boolean value
+  bool ReadBool();
+
+  /// @brief Skips the next value whatever it is
+  void Skip();
+
+ private:
+  /// @brief Skips whitespaces and returns the next character without consuming it
+  char Peek();
+
+  /// @brief Consumes the specified character or throws
+  void Expect(char c);
+
+  /// @brief Consumes the separator before the next member or element, or the closing character
+  /// @param close The closing character of the object or array
+  /// @returns FALSE if the closing character has been consumed
+  bool NextMember(char close);
+
+  /// @brief Consumes the specified literal or throws
+  void ExpectLiteral(std::string_view literal);
+
+  /// @brief Appends UTF-8 representation of the \\uXXXX escape sequence. Unpaired surrogates are
+  /// replaced with U+FFFD, since they can not be represented in UTF-8.
+  void ReadUnicodeEscape(std::string* out);
+
+  /// @brief Reads four hexadecimal digits
+  uint32_t ReadHex4();
+
+  [[noreturn]] void Fail(const char* message) const {
+    throw std::runtime_error(std::string("Invalid JSON: ") + message + " at " + std::to_string(pos));
+  }
+
+  const std::string_view input;
+  std::size_t pos;
+  /// @brief Whether an object or array has just been opened, so its first member is not preceded by a comma
+  bool opened;
+};
+} // namespace bs
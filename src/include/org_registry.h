@@ -0,0 +1,66 @@
+#pragma once
+
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bs {
+/// @brief Slack team connected to BambooHR
+struct Org {
+  /// @brief Slack team ID
+  std::string slack_team_id;
+  /// @brief BambooHR organization name as it's used in the API url
+  std::string bamboohr_org;
+  /// @brief BambooHR API secret
+  std::string bamboohr_secret;
+  /// @brief Slack admin user who has installed the application
+  std::string admin_user;
+  /// @brief Slack access token of the admin user. It is set by OrgRegistry::GetOrgs.
+  std::string admin_token;
+};
+
+/// @brief In-memory index of the organizations and Slack user tokens.
+/// It is filled from database once and then updated along with the records, so lookups need neither
+/// decryption nor JSON parsing. It's safe to use from multiple threads.
+class OrgRegistry {
+ public:
+  /// @brief Adds new or replaces existing organization
+  void PutOrg(Org org);
+
+  /// @brief Adds new or replaces existing user's access token
+  /// @param slack_team_id Slack team ID
+  /// @param slack_user_id Slack user ID
+  /// @param access_token Slack access token
+  void PutUserToken(const std::string& slack_team_id, const std::string& slack_user_id, std::string access_token);
+
+  /// @brief Gets the organizations whose admin user's token is known, ordered by Slack team ID
+  std::vector<Org> GetOrgs() const;
+
+  /// @brief Gets user's access token
+  /// @param slack_team_id Slack team ID
+  /// @param slack_user_id Slack user ID
+  /// @param access_token The token to set
+  /// @returns TRUE on success or FALSE if there is no token
+  bool GetUserToken(const std::string& slack_team_id, const std::string& slack_user_id, std::string* access_token) const;
+
+  /// @brief Gets the number of organizations
+  std::size_t size() const {
+    std::shared_lock<std::shared_mutex> lock {mutex};
+    return orgs.size();
+  }
+
+ private:
+  /// @brief Builds a key of the tokens map
+  static std::string TokenKey(const std::string& slack_team_id, const std::string& slack_user_id) {
+    return slack_team_id + ":" + slack_user_id;
+  }
+
+  mutable std::shared_mutex mutex;
+  /// @brief Slack team ID => organization
+  std::map<std::string, Org> orgs;
+  /// @brief Slack team ID and user ID => access token
+  std::unordered_map<std::string, std::string> tokens;
+};
+} // namespace bs
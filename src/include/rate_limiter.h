@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <pplx/pplxtasks.h>
+
+namespace bs {
+/// @brief Paces Slack API requests according to Slack's rate limit tiers.
+/// Every token and API method pair has its own token bucket. Requests which have to wait are delayed
+/// instead of being failed, and HTTP 429 responses block the bucket for the duration provided in the
+/// Retry-After header. Asynchronous requests are delayed by a timer, so no task pool thread is blocked.
+/// Buckets which have been idle long enough to be full again are evicted.
+class SlackRateLimiter {
+ public:
+  /// @brief Slack rate limit tiers
+  enum Tier : uint8_t {
+    TIER_1,
+    TIER_2,
+    TIER_3,
+    TIER_4
+  };
+
+  /// @brief The number of requests per minute which are allowed for each tier
+  static inline const std::map<Tier, unsigned int> kRequestsPerMinute = {
+      {TIER_1, 1},
+      {TIER_2, 20},
+      {TIER_3, 50},
+      {TIER_4, 100}
+  };
+
+  /// @brief Tiers of the API methods that are used by the application
+  static inline const std::map<std::string, Tier> kMethodTiers = {
+      {"users.list", TIER_2},
+      {"users.profile.set", TIER_3},
+      {"users.info", TIER_4},
+      {"api.test", TIER_4},
+      {"oauth.access", TIER_4}
+  };
+
+  /// @brief A tier for methods which are not listed in kMethodTiers
+  static constexpr Tier kDefaultTier {TIER_3};
+
+  /// @brief How many times a throttled request is retried before it is dropped
+  static constexpr unsigned int kMaxRetries {3};
+
+  /// @brief How often (seconds) idle buckets are evicted
+  static constexpr unsigned int kEvictInterval {60};
+
+  /// @brief Rate limiter metrics
+  struct Stats {
+    /// @brief The number of requests which had to wait for the bucket
+    uint64_t delayed;
+    /// @brief Total time spent waiting for the buckets (milliseconds)
+    uint64_t delay_ms;
+    /// @brief The number of HTTP 429 responses
+    uint64_t throttled;
+    /// @brief The number of retries of the throttled requests
+    uint64_t retried;
+    /// @brief The number of throttled requests which have been given up
+    uint64_t dropped;
+  };
+
+  static SlackRateLimiter& GetInstance() {
+    static SlackRateLimiter instance;
+    // Instantiated on first use.
+    return instance;
+  }
+  SlackRateLimiter(SlackRateLimiter const&) = delete;
+  void operator=(SlackRateLimiter const&) = delete;
+
+  /// @brief Gets the API method name from the request URI, e.g. /api/users.list?limit=10 => users.list
+  /// @param uri Request URI
+  static std::string ApiMethod(const std::string& uri);
+
+  /// @brief Blocks the calling thread until the request is allowed to be sent
+  /// @param token API token
+  /// @param api_method API method name
+  void Acquire(const std::string& token, const std::string& api_method);
+
+  /// @brief Gets a task which is completed once the request is allowed to be sent. No thread is blocked.
+  /// @param token API token
+  /// @param api_method API method name
+  pplx::task<void> AcquireAsync(const std::string& token, const std::string& api_method);
+
+  /// @brief Registers HTTP 429 response
+  /// @param token API token
+  /// @param api_method API method name
+  /// @param retry_after A value of the Retry-After header
+  /// @param attempt How many times the request has already been retried
+  /// @returns TRUE if the request should be retried or FALSE if it has to be dropped
+  bool OnThrottled(
+      const std::string& token,
+      const std::string& api_method,
+      const std::chrono::seconds& retry_after,
+      const unsigned int attempt
+  );
+
+  /// @brief Gets a snapshot of the rate limiter metrics
+  Stats GetStats() const;
+
+  /// @brief Gets the number of buckets which are kept
+  std::size_t size();
+
+ private:
+  SlackRateLimiter();
+  ~SlackRateLimiter();
+
+  /// @brief A token bucket. The number of tokens goes below zero when requests are reserved in advance.
+  struct Bucket {
+    /// @brief Available tokens
+    double tokens;
+    /// @brief Tokens per second
+    double rate;
+    /// @brief The maximum number of tokens
+    double capacity;
+    /// @brief The time when tokens were refilled last time
+    std::chrono::steady_clock::time_point updated;
+    /// @brief No requests are allowed before this time (Retry-After)
+    std::chrono::steady_clock::time_point blocked_until;
+  };
+
+  /// @brief Gets the bucket for the token and API method. The mutex must be held.
+  Bucket& GetBucket(const std::string& token, const std::string& api_method);
+
+  /// @brief Reserves a token of the bucket
+  /// @returns How long the request has to wait before it's sent
+  std::chrono::steady_clock::duration Reserve(const std::string& token, const std::string& api_method);
+
+  /// @brief Drops the buckets which would be created in the same state. The mutex must be held.
+  void EvictIdle(std::chrono::steady_clock::time_point now);
+
+  /// @brief Completes the delayed tasks once their time has come
+  void RunTimer();
+
+  /// @brief Guards the buckets map
+  std::mutex mutex;
+  /// @brief token:method => bucket
+  std::map<std::string, Bucket> buckets;
+  /// @brief The time when idle buckets are evicted next time
+  std::chrono::steady_clock::time_point evict_at;
+
+  /// @brief Guards the timer queue
+  std::mutex timer_mutex;
+  std::condition_variable timer_cv;
+  /// @brief Delayed tasks ordered by the time they are completed at
+  std::multimap<std::chrono::steady_clock::time_point, pplx::task_completion_event<void>> timer_queue;
+  bool timer_stopped {false};
+  std::thread timer;
+
+  std::atomic<uint64_t> delayed {0};
+  std::atomic<uint64_t> delay_ms {0};
+  std::atomic<uint64_t> throttled {0};
+  std::atomic<uint64_t> retried {0};
+  std::atomic<uint64_t> dropped {0};
+};
+} // namespace bs
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "org_registry.h"
+
+namespace bs {
+/// @brief Slack OAuth token of a user
+struct UserToken {
+  /// @brief Slack access token
+  std::string access_token;
+  /// @brief Comma separated scopes granted to the token
+  std::string scope;
+};
+
+/// @brief Install command waiting for the user to grant additional permissions
+struct InstallCallback {
+  /// @brief Slack command Response URL
+  std::string response_url;
+  /// @brief Slack user who has started the installation
+  std::string admin_user;
+  /// @brief BambooHR organization name as it's used in the API url
+  std::string bamboohr_org;
+  /// @brief BambooHR API secret
+  std::string bamboohr_secret;
+  /// @brief Unix time when the command has been received
+  int64_t time;
+};
+
+/// @brief The version of the binary record encoding
+constexpr uint8_t kRecordVersion {1};
+
+/// @brief Encodes a record.
+/// A record starts with the encoding version and the record type which are followed by the fields
+/// in the declared order. Strings are prefixed with their length, and all integers are varints.
+/// Organization records do not include the Slack team ID and the admin token as they are stored separately.
+std::string EncodeRecord(const Org& org);
+std::string EncodeRecord(const UserToken& token);
+std::string EncodeRecord(const InstallCallback& callback);
+
+/// @brief Decodes a record. Records stored as JSON by the previous versions are accepted as well.
+/// @returns FALSE if the record is malformed
+bool DecodeRecord(std::string_view data, Org* org);
+bool DecodeRecord(std::string_view data, UserToken* token);
+bool DecodeRecord(std::string_view data, InstallCallback* callback);
+
+/// @brief Checks whether the record has been stored as JSON by the previous versions
+inline bool IsJsonRecord(std::string_view data) {
+  return !data.empty() && data[0] == '{';
+}
+} // namespace bs
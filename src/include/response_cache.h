@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <cpprest/json.h>
+
+namespace bs {
+/// @brief Cache of JSON API responses with TTL and validators for conditional requests.
+/// Entries live in memory and, if it is enabled in config, in database so they survive restarts.
+class ResponseCache {
+ public:
+  /// @brief Cached response
+  struct Entry {
+    /// @brief Request URI the response belongs to
+    std::string uri;
+    /// @brief Parsed response body. It is shared with the callers, so entries are copied without copying the DOM.
+    std::shared_ptr<const web::json::value> body;
+    /// @brief A value of the ETag response header
+    std::string etag;
+    /// @brief A value of the Last-Modified response header
+    std::string last_modified;
+    /// @brief Unix time when the response was fetched or revalidated last time
+    uint64_t fetched_at;
+  };
+
+  /// @brief Cache metrics
+  struct Stats {
+    /// @brief The number of responses served from the cache within TTL
+    uint64_t hits;
+    /// @brief The number of stale responses the server answered 304 Not Modified for
+    uint64_t revalidated;
+    /// @brief The number of responses that had to be fetched and parsed
+    uint64_t misses;
+  };
+
+  static ResponseCache& GetInstance() {
+    static ResponseCache instance;
+    // Instantiated on first use.
+    return instance;
+  }
+  ResponseCache(ResponseCache const&) = delete;
+  void operator=(ResponseCache const&) = delete;
+
+  /// @brief Gets an entry
+  /// @param key A cache key. There is only one entry per key, so it should not depend on volatile query parameters.
+  /// @param uri Request URI. The entry is returned only if it has been stored for the same URI.
+  /// @param res An entry to set
+  /// @returns TRUE if the entry has been found
+  bool Get(const std::string& key, const std::string& uri, Entry* res);
+
+  /// @brief Adds a new or replaces existing entry
+  /// @param key A cache key
+  /// @param entry An entry to store
+  void Put(const std::string& key, const Entry& entry);
+
+  /// @brief Counts a response served from the cache within TTL
+  void Hit() {
+    ++hits;
+  }
+
+  /// @brief Counts a response revalidated by the server
+  void Revalidated() {
+    ++revalidated;
+  }
+
+  /// @brief Counts a response that has been fetched
+  void Miss() {
+    ++misses;
+  }
+
+  /// @brief Gets a snapshot of the cache metrics
+  Stats GetStats() const {
+    return {hits, revalidated, misses};
+  }
+
+ private:
+  ResponseCache() {}
+
+  /// @brief Guards the entries map
+  std::mutex mutex;
+  /// @brief key => entry
+  std::map<std::string, Entry> entries;
+
+  std::atomic<uint64_t> hits {0};
+  std::atomic<uint64_t> revalidated {0};
+  std::atomic<uint64_t> misses {0};
+};
+} // namespace bs
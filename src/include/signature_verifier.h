@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <openssl/evp.h>
+
+namespace bs {
+/// @brief Verifies Slack request signatures.
+/// The HMAC key is created from the signing secret once and every thread reuses its own digest context,
+/// so a request costs a single pass over its body.
+/// Signatures are compared in constant time, and verified timestamp and signature pairs are remembered
+/// for the clock skew window so duplicate deliveries are rejected without hashing.
+class SignatureVerifier {
+ public:
+  static SignatureVerifier& GetInstance();
+
+  /// @brief Creates a verifier of the signing secret. The application uses the shared instance.
+  explicit SignatureVerifier(const std::string& secret);
+  ~SignatureVerifier();
+
+  /// @brief The maximum difference between the request timestamp and the local clock (seconds)
+  static constexpr long kMaxClockSkew {1000};
+
+  /// @brief The maximum number of remembered signatures
+  static constexpr std::size_t kMaxReplayEntries {100000};
+
+  /// @brief Verification results
+  enum Result {
+    VALID,
+    MISMATCH,
+    REPLAYED,
+    STALE
+  };
+
+  /// @brief Verifies the v0 signature of the request
+  /// @param timestamp The value of the X-Slack-Request-Timestamp header
+  /// @param body The raw request body
+  /// @param signature The value of the X-Slack-Signature header
+  /// @param now The local unix time the timestamp is checked against
+  Result Verify(std::string_view timestamp, std::string_view body, std::string_view signature, std::time_t now);
+
+  /// @brief Gets the number of requests rejected as replays
+  uint64_t Replayed() const {
+    return replayed;
+  }
+
+  SignatureVerifier(const SignatureVerifier&) = delete;
+  SignatureVerifier& operator=(const SignatureVerifier&) = delete;
+
+ private:
+  /// @brief Calculates the v0 signature ("v0=" followed by hex digest) of the request
+  /// @param res The signature to set
+  /// @returns FALSE if HMAC could not be calculated
+  bool Sign(std::string_view timestamp, std::string_view body, std::string* res) const;
+
+  /// @brief Drops remembered signatures which are older than the clock skew window
+  void Expire(std::chrono::steady_clock::time_point now);
+
+  /// @brief HMAC key of the signing secret
+  EVP_PKEY* key;
+
+  std::mutex mutex;
+  /// @brief Remembered timestamp and signature pairs
+  std::unordered_set<std::string> seen;
+  /// @brief Remembered pairs in the order they have been verified
+  std::deque<std::pair<std::chrono::steady_clock::time_point, std::string>> seen_order;
+  /// @brief It's read without the lock by the status endpoint
+  std::atomic<uint64_t> replayed {0};
+};
+} // namespace bs
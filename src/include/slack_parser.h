@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "common.h"
+#include "email_index.h"
+
+namespace bs {
+/// @brief Reads a page of the users.list response. Pages contain up to 1000 full profiles, so instead of
+/// building a DOM only the fields of UserProfile are picked from the raw body.
+/// Bots, deleted users and the users who are not accepted are skipped.
+/// @param body A response body
+/// @param accept An index of the user's emails to accept or nullptr to accept everyone
+/// @param users A list to add the members to
+/// @returns A cursor of the next page or empty string if it is the last one
+/// @throws SlackApiError if the response is not successful or std::runtime_error if it is not valid JSON
+std::string ReadUsersListPage(std::string_view body, const EmailIndex* accept, SlackUsersList* users);
+} // namespace bs
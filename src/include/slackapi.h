@@ -146,10 +146,12 @@ class SlackApiClient {
  public:
   /// @brief Slack API base URL
   static inline const std::string kApiUrl = U("https://slack.com/");
+  /// @brief HTTP status code of the throttled requests
+  static constexpr web::http::status_code kTooManyRequests {429};
 
   SlackApiClient(const std::string& kApiToken);
 
-  /// @brief Sends API request
+  /// @brief Sends API request. Throttled requests are paced and retried by SlackRateLimiter.
   /// @param mtd HTTP method
   /// @param uri Request URI
   /// @param json_v JSON is being used in POST HTTP requests
@@ -159,9 +161,21 @@ class SlackApiClient {
       const web::json::value& json_v = kDefaultJsonValue
   );
 
+  /// @brief Sends API request asynchronously.
+  /// Unlike SendRequest it does not record OAuth scopes, so the task does not depend on the client's lifetime.
+  /// The request is paced by SlackRateLimiter without blocking the calling thread or a task pool thread.
+  /// @param mtd HTTP method
+  /// @param uri Request URI
+  /// @param json_v JSON is being used in POST HTTP requests
+  pplx::task<web::json::value> SendRequestAsync(
+      const web::http::method& mtd,
+      const std::string& uri,
+      const web::json::value& json_v = kDefaultJsonValue
+  ) const;
+
   /// @brief Gets the list of the Users.
   /// If the access_token does not have permission to view user email it will return empty list.
-  /// @param accept the list of the the user's emails to accept for the response
+  /// @param accept the list of the the user's emails to accept for the response. Emails are compared case-insensitively.
   SlackUsersList UsersList(const BambooHrUsersList& accept = kDefaultAccept);
 
   /// @brief Sets users profile status
@@ -174,6 +188,17 @@ class SlackApiClient {
       const uint64_t& status_expiration
   );
 
+  /// @brief Sets users profile status asynchronously
+  /// @param slack_id Slack user identifier
+  /// @param to_profile time off profile to set
+  /// @param status_expiration status expiration to set
+  /// @returns A task that is completed once Slack has accepted the status
+  pplx::task<void> UsersProfileSetStatusAsync(
+      const std::string& slack_id,
+      const TimeOffProfile& to_profile,
+      const uint64_t& status_expiration
+  ) const;
+
   /// @brief Gets information about user
   /// @param user_id An user identifier
   /// @returns Detailed information about requested user as JSON object
@@ -200,6 +225,17 @@ class SlackApiClient {
   /// @brief Gets a list of accepted OAuth scopes for the last API request
   std::vector<std::string> GetAcceptedScopes();
  private:
+  /// @brief Sends API request and returns the response as is.
+  /// Throttled requests are paced and retried by SlackRateLimiter.
+  /// @param mtd HTTP method
+  /// @param uri Request URI
+  /// @param json_v JSON is being used in POST HTTP requests
+  web::http::http_response SendRaw(
+      const web::http::method& mtd,
+      const std::string& uri,
+      const web::json::value& json_v = kDefaultJsonValue
+  );
+
   /// @brief API token to sign requests
   const std::string kApiToken;
 
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bs {
+/// @brief Tuning of the persistent backends
+struct StorageOptions {
+  /// @brief Size (bytes) of the LRU cache of uncompressed blocks
+  std::size_t block_cache_size;
+  /// @brief Bits per key of the bloom filter which saves disk reads for missing keys. 0 disables the filter.
+  int bloom_filter_bits;
+  /// @brief Whether blocks are compressed with Snappy
+  bool compression;
+  /// @brief Size (bytes) of the in-memory buffer which is filled before it's written to a sorted file
+  std::size_t write_buffer_size;
+  /// @brief Key prefixes (the part before the first ':') whose records are kept apart by the backends
+  /// which support it. RocksDB keeps each of them in its own column family.
+  std::vector<std::string> key_prefixes;
+};
+
+/// @brief Writes which are applied to the storage atomically
+class StorageBatch {
+ public:
+  /// @brief A single write of the batch
+  struct Operation {
+    std::string key;
+    /// @brief A value to put. It's empty for deletes.
+    std::string value;
+    bool is_delete;
+  };
+
+  /// @brief Adds a record to put
+  void Put(std::string key, std::string value) {
+    operations.push_back({std::move(key), std::move(value), false});
+  }
+
+  /// @brief Adds a record to delete
+  void Delete(std::string key) {
+    operations.push_back({std::move(key), "", true});
+  }
+
+  void Clear() {
+    operations.clear();
+  }
+
+  std::size_t size() const {
+    return operations.size();
+  }
+
+  const std::vector<Operation>& GetOperations() const {
+    return operations;
+  }
+
+ private:
+  std::vector<Operation> operations;
+};
+
+/// @brief Ordered key-value storage which keeps the database records.
+/// Implementations are safe to use from multiple threads.
+class Storage {
+ public:
+  /// @brief Receives records of a scan. Returns FALSE to stop the scan.
+  using Visitor = std::function<bool(std::string_view key, std::string_view value)>;
+
+  virtual ~Storage() = default;
+
+  /// @brief Gets a record
+  /// @param key A record key
+  /// @param value A value to set
+  /// @returns TRUE on success or FALSE if the record does not exist or can not be read
+  bool Get(const std::string& key, std::string* value) {
+    bool found = false;
+
+    return Find(key, value, &found) && found;
+  }
+
+  /// @brief Gets a record, telling a missing record apart from a read error
+  /// @param key A record key
+  /// @param value A value to set
+  /// @param found Whether the record exists to set
+  /// @returns TRUE on success, including a missing record, or FALSE if the record can not be read
+  virtual bool Find(const std::string& key, std::string* value, bool* found) = 0;
+
+  /// @brief Adds new or replaces existing record
+  /// @param key A record key
+  /// @param value A value
+  /// @param sync Whether the write is flushed to disk before returning
+  /// @returns TRUE on success or FALSE on failure
+  virtual bool Put(const std::string& key, const std::string& value, bool sync) = 0;
+
+  /// @brief Deletes a record. Deleting a record which does not exist is not an error.
+  /// @param key A record key
+  /// @param sync Whether the write is flushed to disk before returning
+  /// @returns TRUE on success or FALSE on failure
+  virtual bool Delete(const std::string& key, bool sync) = 0;
+
+  /// @brief Applies all writes of the batch atomically
+  /// @param batch A batch
+  /// @param sync Whether the writes are flushed to disk before returning
+  /// @returns TRUE on success or FALSE on failure
+  virtual bool Write(const StorageBatch& batch, bool sync) = 0;
+
+  /// @brief Visits the records whose keys start with the prefix in key order. Records are read from
+  /// a consistent snapshot, so the visitor may write to the storage.
+  /// @param prefix A key prefix. Empty prefix visits all records.
+  /// @param visitor A function which receives the records
+  /// @returns TRUE on success or FALSE if the records can not be read
+  virtual bool Scan(const std::string& prefix, const Visitor& visitor) = 0;
+
+  /// @brief Reclaims the space taken by deleted and overwritten records
+  virtual void Compact() {}
+
+  /// @brief Gets a backend property. Names other than kStorageProperty* are passed to the backend as is.
+  /// @param name A property name
+  /// @param value A value to set
+  /// @returns TRUE on success or FALSE if the property is not supported
+  virtual bool GetProperty(const std::string&, std::string*) {
+    return false;
+  }
+};
+
+/// @brief Human readable internal statistics
+inline const std::string kStoragePropertyStats {"stats"};
+/// @brief Approximate number of bytes of memory in use
+inline const std::string kStoragePropertyMemoryUsage {"approximate-memory-usage"};
+/// @brief The number of bytes taken by the block cache
+inline const std::string kStoragePropertyBlockCacheUsage {"block-cache-usage"};
+
+/// @brief Names of the storage backends which may be set in config
+inline const std::string kStorageLevelDb {"leveldb"};
+inline const std::string kStorageMemory {"memory"};
+inline const std::string kStorageRocksDb {"rocksdb"};
+
+/// @brief Checks whether the backend is compiled in
+/// @param backend A backend name
+bool IsStorageAvailable(const std::string& backend);
+
+/// @brief Opens a storage. Throws std::runtime_error if it can not be opened.
+/// @param backend A backend name
+/// @param path A database directory. In-memory storage does not use it.
+/// @param options Tuning of the persistent backends
+std::unique_ptr<Storage> OpenStorage(const std::string& backend, const std::string& path, const StorageOptions& options);
+
+/// @brief Opens LevelDB database, creating it if it does not exist
+/// @param path A database directory
+/// @param options Tuning of the database
+std::unique_ptr<Storage> OpenLevelDbStorage(const std::string& path, const StorageOptions& options);
+
+/// @brief Creates a storage which keeps records in memory only. It's meant for tests and benchmarks.
+std::unique_ptr<Storage> OpenMemoryStorage();
+
+#ifdef BS_WITH_ROCKSDB
+/// @brief Opens RocksDB database, creating it if it does not exist
+/// @param path A database directory
+/// @param options Tuning of the database
+std::unique_ptr<Storage> OpenRocksDbStorage(const std::string& path, const StorageOptions& options);
+#endif
+} // namespace bs
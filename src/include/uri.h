@@ -1,7 +1,46 @@
 #pragma once
 
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include <cpprest/details/basic_types.h>
 
 /// @brief Decodes any %## encoding in the given string.
 /// Plus symbols ('+') are decoded to a space character.
-utility::string_t url_decode(const utility::string_t& encoded);
\ No newline at end of file
+utility::string_t url_decode(const utility::string_t& encoded);
+
+/// @brief Parsed application/x-www-form-urlencoded data (a request body or a query string).
+///
+/// The form owns the encoded text and decodes every name and value in place in a single pass,
+/// since a decoded field is never longer than the encoded one. Fields without '%' and '+' are not
+/// rewritten at all. Accessors return views into the owned text which are valid while the form lives.
+class FormData {
+ public:
+  /// @param encoded The encoded text
+  /// @throws uri_exception if the text has an invalid percent-encoding or non-ASCII characters
+  explicit FormData(std::string&& encoded);
+
+  FormData(const FormData&) = delete;
+  FormData& operator=(const FormData&) = delete;
+
+  /// @brief Gets the decoded value of the first field with the given name
+  /// @returns An empty view if the field is missing
+  std::string_view Get(std::string_view name) const;
+
+  /// @brief Checks whether the field is present
+  bool Has(std::string_view name) const;
+
+  /// @brief Gets the number of fields
+  std::size_t size() const {
+    return fields.size();
+  }
+
+ private:
+  /// @brief Decodes the range [begin, end) of the text in place
+  /// @returns The decoded view
+  std::string_view Decode(std::size_t begin, std::size_t end);
+
+  std::string text;
+  std::vector<std::pair<std::string_view, std::string_view>> fields;
+};
@@ -0,0 +1,263 @@
+#include "json_reader.h"
+
+namespace bs {
+char JsonReader::Peek() {
+  while (pos < input.size()) {
+    const char c = input[pos];
+    if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+      return c;
+    }
+    ++pos;
+  }
+
+  Fail("unexpected end of input");
+}
+
+void JsonReader::Expect(char c) {
+  if (Peek() != c) {
+    Fail("unexpected character");
+  }
+  ++pos;
+}
+
+void JsonReader::ExpectLiteral(std::string_view literal) {
+  if (input.compare(pos, literal.size(), literal) != 0) {
+    Fail("unexpected literal");
+  }
+  pos += literal.size();
+}
+
+bool JsonReader::NextMember(char close) {
+  const bool first = opened;
+  opened = false;
+
+  const char c = Peek();
+  if (c == close) {
+    ++pos;
+
+    return false;
+  }
+  // Members after the first one must be separated, and a trailing comma fails on reading the value
+  if (!first) {
+    if (c != ',') {
+      Fail("comma expected");
+    }
+    ++pos;
+  }
+
+  return true;
+}
+
+bool JsonReader::NextKey(std::string* key) {
+  if (!NextMember('}')) {
+    return false;
+  }
+
+  *key = ReadString();
+  Expect(':');
+
+  return true;
+}
+
+bool JsonReader::NextElement() {
+  return NextMember(']');
+}
+
+bool JsonReader::ReadNull() {
+  if (Peek() != 'n') {
+    return false;
+  }
+  ExpectLiteral("null");
+
+  return true;
+}
+
+uint32_t JsonReader::ReadHex4() {
+  if (pos + 4 > input.size()) {
+    Fail("truncated unicode escape");
+  }
+
+  uint32_t cp = 0;
+  for (int i = 0; i < 4; ++i) {
+    const char h = input[pos++];
+    cp <<= 4;
+    if (h >= '0' && h <= '9') {
+      cp |= h - '0';
+    } else if (h >= 'a' && h <= 'f') {
+      cp |= 10 + (h - 'a');
+    } else if (h >= 'A' && h <= 'F') {
+      cp |= 10 + (h - 'A');
+    } else {
+      Fail("invalid unicode escape");
+    }
+  }
+
+  return cp;
+}
+
+void JsonReader::ReadUnicodeEscape(std::string* out) {
+  uint32_t cp = ReadHex4();
+
+  // Characters outside of the BMP are encoded as surrogate pairs
+  if (cp >= 0xD800 && cp <= 0xDBFF) {
+    const std::size_t next = pos;
+    uint32_t low = 0;
+    if (input.compare(pos, 2, "\\u") == 0) {
+      pos += 2;
+      low = ReadHex4();
+    }
+    if (low >= 0xDC00 && low <= 0xDFFF) {
+      cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+    } else {
+      // The following escape is not a part of the pair, so it's read on its own
+      pos = next;
+      cp = 0xFFFD;
+    }
+  } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+    cp = 0xFFFD;
+  }
+
+  if (cp < 0x80) {
+    out->push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out->push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    out->push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    out->push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+std::string JsonReader::ReadString() {
+  Expect('"');
+
+  std::string out;
+  // Copies unescaped runs at once
+  std::size_t run = pos;
+
+  while (true) {
+    if (pos >= input.size()) {
+      Fail("unterminated string");
+    }
+
+    const char c = input[pos];
+    if (c == '"') {
+      out.append(input.data() + run, pos - run);
+      ++pos;
+
+      return out;
+    }
+
+    if (c != '\\') {
+      ++pos;
+      continue;
+    }
+
+    out.append(input.data() + run, pos - run);
+    if (++pos >= input.size()) {
+      Fail("unterminated escape sequence");
+    }
+
+    switch (input[pos++]) {
+      case '"': out.push_back('"'); break;
+      case '\\': out.push_back('\\'); break;
+      case '/': out.push_back('/'); break;
+      case 'b': out.push_back('\b'); break;
+      case 'f': out.push_back('\f'); break;
+      case 'n': out.push_back('\n'); break;
+      case 'r': out.push_back('\r'); break;
+      case 't': out.push_back('\t'); break;
+      case 'u': ReadUnicodeEscape(&out); break;
+      default: Fail("invalid escape sequence");
+    }
+    run = pos;
+  }
+}
+
+int64_t JsonReader::ReadInteger() {
+  Peek();
+
+  bool negative = false;
+  if (pos < input.size() && input[pos] == '-') {
+    negative = true;
+    ++pos;
+  }
+
+  if (pos >= input.size() || input[pos] < '0' || input[pos] > '9') {
+    Fail("number expected");
+  }
+
+  int64_t value = 0;
+  while (pos < input.size() && input[pos] >= '0' && input[pos] <= '9') {
+    value = value * 10 + (input[pos++] - '0');
+  }
+
+  // Fractional part and exponent are not needed
+  while (pos < input.size()
+      && (input[pos] == '.' || input[pos] == 'e' || input[pos] == 'E' || input[pos] == '+' || input[pos] == '-'
+          || (input[pos] >= '0' && input[pos] <= '9'))) {
+    ++pos;
+  }
+
+  return negative ? -value : value;
+}
+
+bool JsonReader::ReadBool() {
+  if (Peek() == 't') {
+    ExpectLiteral("true");
+
+    return true;
+  }
+  ExpectLiteral("false");
+
+  return false;
+}
+
+void JsonReader::Skip() {
+  switch (Peek()) {
+    case '{': {
+      BeginObject();
+      std::string key;
+      while (NextKey(&key)) {
+        Skip();
+      }
+      break;
+    }
+    case '[':
+      BeginArray();
+      while (NextElement()) {
+        Skip();
+      }
+      break;
+    case '"':
+      // Skips the string without unescaping it
+      for (++pos; ; ++pos) {
+        if (pos >= input.size()) {
+          Fail("unterminated string");
+        }
+        if (input[pos] == '\\') {
+          ++pos;
+        } else if (input[pos] == '"') {
+          ++pos;
+          break;
+        }
+      }
+      break;
+    case 't':
+    case 'f':
+      ReadBool();
+      break;
+    case 'n':
+      ReadNull();
+      break;
+    default:
+      ReadInteger();
+  }
+}
+} // namespace bs
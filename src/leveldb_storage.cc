@@ -0,0 +1,117 @@
+#include <stdexcept>
+#include <leveldb/cache.h>
+#include <leveldb/db.h>
+#include <leveldb/filter_policy.h>
+#include <leveldb/write_batch.h>
+#include "storage.h"
+
+namespace bs {
+/// @brief Storage backed by LevelDB
+class LevelDbStorage : public Storage {
+ public:
+  LevelDbStorage(const std::string& path, const StorageOptions& storage_options)
+      : block_cache(leveldb::NewLRUCache(storage_options.block_cache_size)) {
+    options.create_if_missing = true;
+    options.block_cache = block_cache.get();
+    // Most of the lookups are point reads, and a filter lets the missing keys skip reading the blocks
+    if (storage_options.bloom_filter_bits > 0) {
+      filter_policy.reset(leveldb::NewBloomFilterPolicy(storage_options.bloom_filter_bits));
+      options.filter_policy = filter_policy.get();
+    }
+    options.compression = storage_options.compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
+    options.write_buffer_size = storage_options.write_buffer_size;
+
+    leveldb::Status status = leveldb::DB::Open(options, path, &db);
+    if (!status.ok()) {
+      throw std::runtime_error("Could not connect to database " + path);
+    }
+  }
+
+  LevelDbStorage(const LevelDbStorage&) = delete;
+  LevelDbStorage& operator=(const LevelDbStorage&) = delete;
+
+  ~LevelDbStorage() override {
+    // The cache and the filter policy are used by the database until it's closed
+    delete db;
+  }
+
+  bool Find(const std::string& key, std::string* value, bool* found) override {
+    const leveldb::Status status = db->Get(leveldb::ReadOptions(), key, value);
+    *found = status.ok();
+
+    return status.ok() || status.IsNotFound();
+  }
+
+  bool Put(const std::string& key, const std::string& value, bool sync) override {
+    return db->Put(GetWriteOptions(sync), key, value).ok();
+  }
+
+  bool Delete(const std::string& key, bool sync) override {
+    return db->Delete(GetWriteOptions(sync), key).ok();
+  }
+
+  bool Write(const StorageBatch& batch, bool sync) override {
+    leveldb::WriteBatch write_batch;
+    for (const auto& op : batch.GetOperations()) {
+      if (op.is_delete) {
+        write_batch.Delete(op.key);
+      } else {
+        write_batch.Put(op.key, op.value);
+      }
+    }
+
+    return db->Write(GetWriteOptions(sync), &write_batch).ok();
+  }
+
+  bool Scan(const std::string& prefix, const Visitor& visitor) override {
+    // An iterator reads from an implicit snapshot
+    std::unique_ptr<leveldb::Iterator> it {db->NewIterator(leveldb::ReadOptions())};
+    for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+      const leveldb::Slice key = it->key();
+      const leveldb::Slice value = it->value();
+      if (!visitor({key.data(), key.size()}, {value.data(), value.size()})) {
+        break;
+      }
+    }
+
+    return it->status().ok();
+  }
+
+  void Compact() override {
+    db->CompactRange(nullptr, nullptr);
+  }
+
+  bool GetProperty(const std::string& name, std::string* value) override {
+    if (name == kStoragePropertyBlockCacheUsage) {
+      *value = std::to_string(block_cache->TotalCharge());
+      return true;
+    }
+    if (name == kStoragePropertyStats || name == kStoragePropertyMemoryUsage) {
+      return db->GetProperty("leveldb." + name, value);
+    }
+
+    return db->GetProperty(name, value);
+  }
+
+ private:
+  static leveldb::WriteOptions GetWriteOptions(bool sync) {
+    leveldb::WriteOptions write_options;
+    write_options.sync = sync;
+
+    return write_options;
+  }
+
+  /// @brief LRU cache of uncompressed blocks
+  std::unique_ptr<leveldb::Cache> block_cache;
+  /// @brief Bloom filter policy. It's not set if the filter is disabled.
+  std::unique_ptr<const leveldb::FilterPolicy> filter_policy;
+  /// @brief leveldb database instance
+  leveldb::DB* db;
+  /// @brief leveldb database options
+  leveldb::Options options;
+};
+
+std::unique_ptr<Storage> OpenLevelDbStorage(const std::string& path, const StorageOptions& options) {
+  return std::make_unique<LevelDbStorage>(path, options);
+}
+} // namespace bs
@@ -125,6 +125,24 @@ int main(int argc, char* argv[]) {
   LOG(INFO) << "Starting service...";
   bs::InterruptHandler::HookSIGINT();
 
+  try {
+    uint64_t migrated = 0;
+    uint64_t failed = 0;
+    if (!bs::DB::GetInstance().MigrateStorage(&migrated, &failed)) {
+      LOG(ERROR) << "Records could not be converted to the current storage format.";
+    }
+    if (failed > 0) {
+      LOG(ERROR) << "Storage: " << failed << " records could not be decrypted and have been left as is.";
+    }
+    if (migrated > 0) {
+      LOG(INFO) << "Storage: " << migrated << " records converted to format "
+                << bs::DB::kStorageFormatVersion << ".";
+    }
+  } catch (std::exception& e) {
+    LOG(FATAL) << "Unable to open database. Error: " << e.what();
+    exit(EXIT_FAILURE);
+  }
+
   bs::AppController server;
 
   try {
@@ -145,6 +163,8 @@ int main(int argc, char* argv[]) {
 
   // Start periodic tack to sync user profile statuses in separate thread
   timer_start(bs::SyncUserProfileStatuses, 600);
+  // Start periodic tack to delete abandoned install callbacks in separate thread
+  timer_start(bs::ReapInstallCallbacks, bs::kInstallCallbackReapInterval);
 
   try {
     bs::InterruptHandler::WaitForUserInterrupt();
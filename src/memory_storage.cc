@@ -0,0 +1,97 @@
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include "storage.h"
+
+namespace bs {
+/// @brief Storage which keeps records in an ordered map. Nothing is persisted.
+class MemoryStorage : public Storage {
+ public:
+  bool Find(const std::string& key, std::string* value, bool* found) override {
+    std::shared_lock<std::shared_mutex> lock {mutex};
+    const auto it = records.find(key);
+    *found = it != records.end();
+    if (*found) {
+      *value = it->second;
+    }
+
+    return true;
+  }
+
+  bool Put(const std::string& key, const std::string& value, bool) override {
+    std::unique_lock<std::shared_mutex> lock {mutex};
+    records[key] = value;
+
+    return true;
+  }
+
+  bool Delete(const std::string& key, bool) override {
+    std::unique_lock<std::shared_mutex> lock {mutex};
+    records.erase(key);
+
+    return true;
+  }
+
+  bool Write(const StorageBatch& batch, bool) override {
+    std::unique_lock<std::shared_mutex> lock {mutex};
+    for (const auto& op : batch.GetOperations()) {
+      if (op.is_delete) {
+        records.erase(op.key);
+      } else {
+        records[op.key] = op.value;
+      }
+    }
+
+    return true;
+  }
+
+  bool Scan(const std::string& prefix, const Visitor& visitor) override {
+    // The matching records are copied, so the visitor may write without deadlocking or invalidating iterators
+    std::vector<std::pair<std::string, std::string>> snapshot;
+    {
+      std::shared_lock<std::shared_mutex> lock {mutex};
+      for (auto it = records.lower_bound(prefix);
+           it != records.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+           ++it) {
+        snapshot.emplace_back(*it);
+      }
+    }
+
+    for (const auto& [key, value] : snapshot) {
+      if (!visitor(key, value)) {
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  bool GetProperty(const std::string& name, std::string* value) override {
+    std::shared_lock<std::shared_mutex> lock {mutex};
+    if (name == kStoragePropertyStats) {
+      *value = "records: " + std::to_string(records.size());
+      return true;
+    }
+    if (name == kStoragePropertyMemoryUsage) {
+      // Only the keys and values are counted, not the map nodes
+      std::size_t usage = 0;
+      for (const auto& [key, record] : records) {
+        usage += key.size() + record.size();
+      }
+      *value = std::to_string(usage);
+      return true;
+    }
+
+    return false;
+  }
+
+ private:
+  std::map<std::string, std::string> records;
+  mutable std::shared_mutex mutex;
+};
+
+std::unique_ptr<Storage> OpenMemoryStorage() {
+  return std::make_unique<MemoryStorage>();
+}
+} // namespace bs
@@ -0,0 +1,56 @@
+#include <mutex>
+#include "org_registry.h"
+
+namespace bs {
+void OrgRegistry::PutOrg(Org org) {
+  org.admin_token.clear();
+
+  std::unique_lock<std::shared_mutex> lock {mutex};
+  auto slack_team_id = org.slack_team_id;
+  orgs[std::move(slack_team_id)] = std::move(org);
+}
+
+void OrgRegistry::PutUserToken(
+    const std::string& slack_team_id,
+    const std::string& slack_user_id,
+    std::string access_token
+) {
+  auto key = TokenKey(slack_team_id, slack_user_id);
+
+  std::unique_lock<std::shared_mutex> lock {mutex};
+  tokens[std::move(key)] = std::move(access_token);
+}
+
+std::vector<Org> OrgRegistry::GetOrgs() const {
+  std::vector<Org> ret;
+
+  std::shared_lock<std::shared_mutex> lock {mutex};
+  ret.reserve(orgs.size());
+  for (const auto& [slack_team_id, org] : orgs) {
+    auto it = tokens.find(TokenKey(slack_team_id, org.admin_user));
+    if (it == tokens.end()) {
+      // The team can not be synchronized without the admin token
+      continue;
+    }
+    ret.push_back(org);
+    ret.back().admin_token = it->second;
+  }
+
+  return ret;
+}
+
+bool OrgRegistry::GetUserToken(
+    const std::string& slack_team_id,
+    const std::string& slack_user_id,
+    std::string* access_token
+) const {
+  std::shared_lock<std::shared_mutex> lock {mutex};
+  auto it = tokens.find(TokenKey(slack_team_id, slack_user_id));
+  if (it == tokens.end()) {
+    return false;
+  }
+  *access_token = it->second;
+
+  return true;
+}
+} // namespace bs
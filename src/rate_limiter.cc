@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <thread>
+#include "rate_limiter.h"
+
+namespace bs {
+using std::chrono::steady_clock;
+
+std::string SlackRateLimiter::ApiMethod(const std::string& uri) {
+  const std::string prefix {"/api/"};
+  auto begin = uri.compare(0, prefix.size(), prefix) == 0 ? prefix.size() : 0;
+
+  return uri.substr(begin, uri.find('?', begin) - begin);
+}
+
+SlackRateLimiter::SlackRateLimiter() : evict_at(steady_clock::now() + std::chrono::seconds(kEvictInterval)) {
+  timer = std::thread(&SlackRateLimiter::RunTimer, this);
+}
+
+SlackRateLimiter::~SlackRateLimiter() {
+  {
+    std::lock_guard<std::mutex> lock {timer_mutex};
+    timer_stopped = true;
+  }
+  timer_cv.notify_one();
+  timer.join();
+}
+
+SlackRateLimiter::Bucket& SlackRateLimiter::GetBucket(const std::string& token, const std::string& api_method) {
+  const std::string key = token + ":" + api_method;
+
+  if (auto it = buckets.find(key); it != buckets.end()) {
+    return it->second;
+  }
+
+  auto tier_iter = kMethodTiers.find(api_method);
+  const double rpm = kRequestsPerMinute.at(tier_iter != kMethodTiers.end() ? tier_iter->second : kDefaultTier);
+  // Slack tolerates short bursts, so a tenth of the minute limit can be sent at once
+  const double capacity = std::max(1.0, rpm / 10);
+  const auto now = steady_clock::now();
+
+  return buckets[key] = {capacity, rpm / 60, capacity, now, now};
+}
+
+void SlackRateLimiter::EvictIdle(steady_clock::time_point now) {
+  for (auto it = buckets.begin(); it != buckets.end();) {
+    const Bucket& b = it->second;
+    // A bucket which is not blocked and has refilled completely is the same as a new one
+    const bool idle = now >= b.blocked_until && now >= b.updated
+        && b.tokens + std::chrono::duration<double>(now - b.updated).count() * b.rate >= b.capacity;
+    it = idle ? buckets.erase(it) : std::next(it);
+  }
+}
+
+steady_clock::duration SlackRateLimiter::Reserve(const std::string& token, const std::string& api_method) {
+  steady_clock::duration wait;
+
+  {
+    std::lock_guard<std::mutex> lock {mutex};
+    const auto now = steady_clock::now();
+    if (now >= evict_at) {
+      EvictIdle(now);
+      evict_at = now + std::chrono::seconds(kEvictInterval);
+    }
+
+    Bucket& b = GetBucket(token, api_method);
+    const auto ready_at = std::max(now, b.blocked_until);
+
+    // Refills the bucket up to the moment the request may be sent
+    if (ready_at > b.updated) {
+      b.tokens = std::min(
+          b.capacity,
+          b.tokens + std::chrono::duration<double>(ready_at - b.updated).count() * b.rate
+      );
+      b.updated = ready_at;
+    }
+
+    // Reserves a token. If there is none the request waits until the bucket pays off its debt.
+    b.tokens -= 1;
+    wait = ready_at - now;
+    if (b.tokens < 0) {
+      wait += std::chrono::duration_cast<steady_clock::duration>(
+          std::chrono::duration<double>(-b.tokens / b.rate)
+      );
+    }
+  }
+
+  if (wait > steady_clock::duration::zero()) {
+    ++delayed;
+    delay_ms += std::chrono::duration_cast<std::chrono::milliseconds>(wait).count();
+  }
+
+  return wait;
+}
+
+void SlackRateLimiter::Acquire(const std::string& token, const std::string& api_method) {
+  const auto wait = Reserve(token, api_method);
+  if (wait > steady_clock::duration::zero()) {
+    std::this_thread::sleep_for(wait);
+  }
+}
+
+pplx::task<void> SlackRateLimiter::AcquireAsync(const std::string& token, const std::string& api_method) {
+  const auto wait = Reserve(token, api_method);
+  if (wait <= steady_clock::duration::zero()) {
+    return pplx::task_from_result();
+  }
+
+  pplx::task_completion_event<void> ready;
+  {
+    std::lock_guard<std::mutex> lock {timer_mutex};
+    timer_queue.emplace(steady_clock::now() + wait, ready);
+  }
+  timer_cv.notify_one();
+
+  return pplx::task<void>(ready);
+}
+
+void SlackRateLimiter::RunTimer() {
+  std::unique_lock<std::mutex> lock {timer_mutex};
+  while (!timer_stopped) {
+    if (timer_queue.empty()) {
+      timer_cv.wait(lock);
+      continue;
+    }
+
+    const auto next = timer_queue.begin()->first;
+    if (steady_clock::now() < next) {
+      timer_cv.wait_until(lock, next);
+      continue;
+    }
+
+    auto ready = timer_queue.begin()->second;
+    timer_queue.erase(timer_queue.begin());
+    // Continuations are scheduled on the task pool, so the timer thread only hands them over
+    lock.unlock();
+    ready.set();
+    lock.lock();
+  }
+}
+
+std::size_t SlackRateLimiter::size() {
+  std::lock_guard<std::mutex> lock {mutex};
+
+  return buckets.size();
+}
+
+bool SlackRateLimiter::OnThrottled(
+    const std::string& token,
+    const std::string& api_method,
+    const std::chrono::seconds& retry_after,
+    const unsigned int attempt
+) {
+  ++throttled;
+
+  {
+    std::lock_guard<std::mutex> lock {mutex};
+    Bucket& b = GetBucket(token, api_method);
+    // Nothing is refilled while the bucket is blocked, and only one request is let through right after that
+    b.blocked_until = std::max(b.blocked_until, steady_clock::now() + retry_after);
+    b.updated = std::max(b.updated, b.blocked_until);
+    b.tokens = std::min(b.tokens, 1.0);
+  }
+
+  if (attempt >= kMaxRetries) {
+    ++dropped;
+
+    return false;
+  }
+
+  ++retried;
+
+  return true;
+}
+
+SlackRateLimiter::Stats SlackRateLimiter::GetStats() const {
+  return {delayed, delay_ms, throttled, retried, dropped};
+}
+} // namespace bs
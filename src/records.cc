@@ -0,0 +1,208 @@
+#include <cpprest/json.h>
+#include "records.h"
+
+using namespace web;
+
+namespace bs {
+namespace {
+/// @brief Record types
+enum RecordType : uint8_t {
+  kRecordOrg = 'O',
+  kRecordUserToken = 'T',
+  kRecordInstallCallback = 'C'
+};
+
+/// @brief Appends fields to a record
+class RecordWriter {
+ public:
+  RecordWriter(RecordType type, std::size_t size_hint) {
+    data.reserve(2 + size_hint);
+    data.push_back(static_cast<char>(kRecordVersion));
+    data.push_back(static_cast<char>(type));
+  }
+
+  RecordWriter& Write(uint64_t value) {
+    while (value >= 0x80) {
+      data.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    data.push_back(static_cast<char>(value));
+
+    return *this;
+  }
+
+  RecordWriter& Write(std::string_view value) {
+    Write(static_cast<uint64_t>(value.size()));
+    data.append(value);
+
+    return *this;
+  }
+
+  std::string data;
+};
+
+/// @brief Reads fields of a record. Any read past the end fails the reader.
+class RecordReader {
+ public:
+  RecordReader(std::string_view data, RecordType type) : data(data), pos(2) {
+    ok = data.size() >= 2 && static_cast<uint8_t>(data[0]) == kRecordVersion && static_cast<uint8_t>(data[1]) == type;
+  }
+
+  RecordReader& Read(uint64_t* value) {
+    *value = 0;
+    for (unsigned int shift = 0; ok; shift += 7) {
+      if (pos == data.size()) {
+        ok = false;
+        break;
+      }
+      const auto byte = static_cast<uint8_t>(data[pos++]);
+      // The tenth byte holds the last bit only, anything else does not fit 64 bits
+      if (shift == 63 && byte > 1) {
+        ok = false;
+        break;
+      }
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        break;
+      }
+    }
+
+    return *this;
+  }
+
+  RecordReader& Read(int64_t* value) {
+    uint64_t v = 0;
+    Read(&v);
+    *value = static_cast<int64_t>(v);
+
+    return *this;
+  }
+
+  RecordReader& Read(std::string* value) {
+    uint64_t size = 0;
+    Read(&size);
+    if (ok && size > data.size() - pos) {
+      ok = false;
+    }
+    if (ok) {
+      value->assign(data.substr(pos, size));
+      pos += size;
+    }
+
+    return *this;
+  }
+
+  /// @brief Checks whether all the fields have been read
+  bool Done() const {
+    return ok && pos == data.size();
+  }
+
+ private:
+  std::string_view data;
+  std::size_t pos;
+  bool ok;
+};
+
+/// @brief Parses a record stored as JSON by the previous versions
+/// @returns Null value if it's not a JSON object
+json::value ParseJsonRecord(std::string_view data) {
+  try {
+    auto jv = json::value::parse(utility::conversions::to_string_t(std::string(data)));
+
+    return jv.is_object() ? jv : json::value::null();
+  } catch (json::json_exception&) {
+    return json::value::null();
+  }
+}
+
+/// @brief Gets a string field of a JSON record
+std::string JsonString(const json::value& jv, const utility::string_t& name) {
+  return jv.has_field(name) && jv.at(name).is_string() ? jv.at(name).as_string() : "";
+}
+} // namespace
+
+std::string EncodeRecord(const Org& org) {
+  RecordWriter w {kRecordOrg, org.bamboohr_org.size() + org.bamboohr_secret.size() + org.admin_user.size() + 3};
+  w.Write(org.bamboohr_org).Write(org.bamboohr_secret).Write(org.admin_user);
+
+  return std::move(w.data);
+}
+
+std::string EncodeRecord(const UserToken& token) {
+  RecordWriter w {kRecordUserToken, token.access_token.size() + token.scope.size() + 2};
+  w.Write(token.access_token).Write(token.scope);
+
+  return std::move(w.data);
+}
+
+std::string EncodeRecord(const InstallCallback& callback) {
+  RecordWriter w {
+      kRecordInstallCallback,
+      callback.response_url.size() + callback.admin_user.size() + callback.bamboohr_org.size()
+          + callback.bamboohr_secret.size() + 14
+  };
+  w.Write(callback.response_url)
+      .Write(callback.admin_user)
+      .Write(callback.bamboohr_org)
+      .Write(callback.bamboohr_secret)
+      .Write(static_cast<uint64_t>(callback.time));
+
+  return std::move(w.data);
+}
+
+bool DecodeRecord(std::string_view data, Org* org) {
+  if (IsJsonRecord(data)) {
+    const auto jv = ParseJsonRecord(data);
+    org->bamboohr_org = JsonString(jv, U("bamboohr_org"));
+    org->bamboohr_secret = JsonString(jv, U("bamboohr_secret"));
+    org->admin_user = JsonString(jv, U("admin_user"));
+
+    return !org->admin_user.empty();
+  }
+
+  return RecordReader(data, kRecordOrg)
+      .Read(&org->bamboohr_org)
+      .Read(&org->bamboohr_secret)
+      .Read(&org->admin_user)
+      .Done();
+}
+
+bool DecodeRecord(std::string_view data, UserToken* token) {
+  if (IsJsonRecord(data)) {
+    // The whole oauth.access response used to be stored
+    const auto jv = ParseJsonRecord(data);
+    token->access_token = JsonString(jv, U("access_token"));
+    token->scope = JsonString(jv, U("scope"));
+
+    return !token->access_token.empty();
+  }
+
+  return RecordReader(data, kRecordUserToken)
+      .Read(&token->access_token)
+      .Read(&token->scope)
+      .Done();
+}
+
+bool DecodeRecord(std::string_view data, InstallCallback* callback) {
+  if (IsJsonRecord(data)) {
+    const auto jv = ParseJsonRecord(data);
+    callback->response_url = JsonString(jv, U("response_url"));
+    callback->admin_user = JsonString(jv, U("admin_user"));
+    callback->bamboohr_org = JsonString(jv, U("bamboohr_org"));
+    callback->bamboohr_secret = JsonString(jv, U("bamboohr_secret"));
+    callback->time = jv.has_field(U("time")) && jv.at(U("time")).is_number()
+        ? jv.at(U("time")).as_number().to_int64()
+        : 0;
+
+    return !callback->response_url.empty();
+  }
+
+  return RecordReader(data, kRecordInstallCallback)
+      .Read(&callback->response_url)
+      .Read(&callback->admin_user)
+      .Read(&callback->bamboohr_org)
+      .Read(&callback->bamboohr_secret)
+      .Read(&callback->time)
+      .Done();
+}
+} // namespace bs
@@ -0,0 +1,81 @@
+#include "common.h"
+#include "db.h"
+#include "easylogging++.h"
+#include "response_cache.h"
+
+using namespace web;
+
+namespace bs {
+bool ResponseCache::Get(const std::string& key, const std::string& uri, Entry* res) {
+  {
+    std::lock_guard<std::mutex> lock {mutex};
+    if (auto it = entries.find(key); it != entries.end()) {
+      if (it->second.uri != uri) {
+        return false;
+      }
+      *res = it->second;
+
+      return true;
+    }
+  }
+
+  if (!app_config.kBambooHrCachePersistent) {
+    return false;
+  }
+
+  // Falls back to the copy stored before restart
+  Entry entry;
+  try {
+    std::string data;
+    if (!DB::GetInstance().GetResponseCache(key, &data)) {
+      return false;
+    }
+
+    auto jv = json::value::parse(data);
+    if (!jv.is_object() || jv.at(U("uri")).as_string() != uri) {
+      return false;
+    }
+
+    entry = {
+        uri,
+        std::make_shared<const json::value>(json::value::parse(jv.at(U("body")).as_string())),
+        jv.at(U("etag")).as_string(),
+        jv.at(U("last_modified")).as_string(),
+        static_cast<uint64_t>(jv.at(U("time")).as_number().to_int64())
+    };
+  } catch (std::exception& e) {
+    // The copy is corrupt or can not be decrypted. It's dropped, so the response is fetched and stored again.
+    LOG(ERROR) << "Unable to read cached response " << key << ": " << e.what();
+    DB::GetInstance().DeleteResponseCache(key);
+
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock {mutex};
+  *res = entries[key] = entry;
+
+  return true;
+}
+
+void ResponseCache::Put(const std::string& key, const Entry& entry) {
+  {
+    std::lock_guard<std::mutex> lock {mutex};
+    entries[key] = entry;
+  }
+
+  if (!app_config.kBambooHrCachePersistent) {
+    return;
+  }
+
+  json::value jv;
+  jv[U("uri")] = json::value::string(entry.uri);
+  jv[U("body")] = json::value::string(entry.body->serialize());
+  jv[U("etag")] = json::value::string(entry.etag);
+  jv[U("last_modified")] = json::value::string(entry.last_modified);
+  jv[U("time")] = json::value::number(entry.fetched_at);
+
+  if (!DB::GetInstance().PutResponseCache(key, jv.serialize())) {
+    LOG(ERROR) << "Unable to store cached response to database.";
+  }
+}
+} // namespace bs
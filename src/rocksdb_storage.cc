@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <rocksdb/cache.h>
+#include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/table.h>
+#include <rocksdb/write_batch.h>
+#include "storage.h"
+
+namespace bs {
+/// @brief Storage backed by RocksDB. Records of every key prefix are kept in the column family named
+/// after the prefix, and the other records in the default one. Families have their own memtables and
+/// sorted files, so the frequently rewritten records are compacted without rewriting the rest,
+/// and a prefix scan reads only the files of its family.
+class RocksDbStorage : public Storage {
+ public:
+  RocksDbStorage(const std::string& path, const StorageOptions& storage_options)
+      : block_cache(rocksdb::NewLRUCache(storage_options.block_cache_size)) {
+    options.create_if_missing = true;
+    options.create_missing_column_families = true;
+
+    rocksdb::BlockBasedTableOptions table_options;
+    table_options.block_cache = block_cache;
+    if (storage_options.bloom_filter_bits > 0) {
+      table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(storage_options.bloom_filter_bits));
+    }
+    options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+    options.compression = storage_options.compression ? rocksdb::kSnappyCompression : rocksdb::kNoCompression;
+    options.write_buffer_size = storage_options.write_buffer_size;
+
+    // Every family of the database must be opened, including the ones which are not configured anymore
+    std::vector<std::string> names {rocksdb::kDefaultColumnFamilyName};
+    names.insert(names.end(), storage_options.key_prefixes.begin(), storage_options.key_prefixes.end());
+    std::vector<std::string> existing;
+    if (rocksdb::DB::ListColumnFamilies(options, path, &existing).ok()) {
+      names.insert(names.end(), existing.begin(), existing.end());
+    }
+    std::sort(names.begin() + 1, names.end());
+    names.erase(std::unique(names.begin() + 1, names.end()), names.end());
+    names.erase(std::remove(names.begin() + 1, names.end(), rocksdb::kDefaultColumnFamilyName), names.end());
+
+    // The families share the block cache and the tuning
+    const rocksdb::ColumnFamilyOptions family_options(options);
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+    for (const auto& name : names) {
+      descriptors.emplace_back(name, family_options);
+    }
+
+    rocksdb::Status status = rocksdb::DB::Open(options, path, descriptors, &handles, &db);
+    if (!status.ok()) {
+      throw std::runtime_error("Could not connect to database " + path);
+    }
+
+    for (auto handle : handles) {
+      if (handle->GetName() != rocksdb::kDefaultColumnFamilyName) {
+        families.emplace(handle->GetName(), handle);
+      }
+    }
+
+    if (!MoveToFamilies()) {
+      throw std::runtime_error("Could not move records to column families in database " + path);
+    }
+  }
+
+  RocksDbStorage(const RocksDbStorage&) = delete;
+  RocksDbStorage& operator=(const RocksDbStorage&) = delete;
+
+  ~RocksDbStorage() override {
+    for (auto handle : handles) {
+      db->DestroyColumnFamilyHandle(handle);
+    }
+    delete db;
+  }
+
+  bool Find(const std::string& key, std::string* value, bool* found) override {
+    const rocksdb::Status status = db->Get(rocksdb::ReadOptions(), GetFamily(key), key, value);
+    *found = status.ok();
+
+    return status.ok() || status.IsNotFound();
+  }
+
+  bool Put(const std::string& key, const std::string& value, bool sync) override {
+    return db->Put(GetWriteOptions(sync), GetFamily(key), key, value).ok();
+  }
+
+  bool Delete(const std::string& key, bool sync) override {
+    return db->Delete(GetWriteOptions(sync), GetFamily(key), key).ok();
+  }
+
+  bool Write(const StorageBatch& batch, bool sync) override {
+    rocksdb::WriteBatch write_batch;
+    for (const auto& op : batch.GetOperations()) {
+      if (op.is_delete) {
+        write_batch.Delete(GetFamily(op.key), op.key);
+      } else {
+        write_batch.Put(GetFamily(op.key), op.key, op.value);
+      }
+    }
+
+    return db->Write(GetWriteOptions(sync), &write_batch).ok();
+  }
+
+  bool Scan(const std::string& prefix, const Visitor& visitor) override {
+    // A prefix which includes the separator belongs to a single family
+    if (prefix.find(':') != std::string::npos) {
+      // An iterator reads from an implicit snapshot
+      std::unique_ptr<rocksdb::Iterator> it {db->NewIterator(rocksdb::ReadOptions(), GetFamily(prefix))};
+      for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next()) {
+        const rocksdb::Slice key = it->key();
+        const rocksdb::Slice value = it->value();
+        if (!visitor({key.data(), key.size()}, {value.data(), value.size()})) {
+          break;
+        }
+      }
+
+      return it->status().ok();
+    }
+
+    return ScanFamilies(prefix, visitor);
+  }
+
+  void Compact() override {
+    for (auto handle : handles) {
+      db->CompactRange(rocksdb::CompactRangeOptions(), handle, nullptr, nullptr);
+    }
+  }
+
+  bool GetProperty(const std::string& name, std::string* value) override {
+    if (name == kStoragePropertyBlockCacheUsage) {
+      *value = std::to_string(block_cache->GetUsage());
+      return true;
+    }
+    if (name == kStoragePropertyStats) {
+      // The stats of the default family include the database-wide ones, the rest add their own only
+      value->clear();
+      for (auto handle : handles) {
+        std::string stats;
+        const bool is_default = handle == db->DefaultColumnFamily();
+        if (!db->GetProperty(handle, is_default ? "rocksdb.stats" : "rocksdb.cfstats", &stats)) {
+          return false;
+        }
+        value->append(stats);
+      }
+      return true;
+    }
+    if (name == kStoragePropertyMemoryUsage) {
+      // Unlike LevelDB there is no single property, so the memtables and the table readers of every family
+      // are summed up
+      uint64_t usage = block_cache->GetUsage();
+      for (auto handle : handles) {
+        uint64_t memtables = 0;
+        uint64_t table_readers = 0;
+        if (!db->GetIntProperty(handle, "rocksdb.cur-size-all-mem-tables", &memtables)
+            || !db->GetIntProperty(handle, "rocksdb.estimate-table-readers-mem", &table_readers)) {
+          return false;
+        }
+        usage += memtables + table_readers;
+      }
+      *value = std::to_string(usage);
+      return true;
+    }
+
+    return db->GetProperty(name, value);
+  }
+
+ private:
+  static rocksdb::WriteOptions GetWriteOptions(bool sync) {
+    rocksdb::WriteOptions write_options;
+    write_options.sync = sync;
+
+    return write_options;
+  }
+
+  /// @brief Gets the family of the key
+  rocksdb::ColumnFamilyHandle* GetFamily(std::string_view key) const {
+    const auto it = families.find(key.substr(0, key.find(':')));
+
+    return it == families.end() ? db->DefaultColumnFamily() : it->second;
+  }
+
+  /// @brief Visits the records of all families in key order by merging their iterators
+  bool ScanFamilies(const std::string& prefix, const Visitor& visitor) {
+    // The iterators read from the same snapshot
+    std::vector<rocksdb::Iterator*> raw;
+    if (!db->NewIterators(rocksdb::ReadOptions(), handles, &raw).ok()) {
+      return false;
+    }
+    std::vector<std::unique_ptr<rocksdb::Iterator>> iterators;
+    for (auto it : raw) {
+      iterators.emplace_back(it);
+      it->Seek(prefix);
+    }
+
+    while (true) {
+      rocksdb::Iterator* next = nullptr;
+      for (const auto& it : iterators) {
+        if (it->Valid() && it->key().starts_with(prefix) && (!next || it->key().compare(next->key()) < 0)) {
+          next = it.get();
+        }
+      }
+      if (!next) {
+        break;
+      }
+
+      const rocksdb::Slice key = next->key();
+      const rocksdb::Slice value = next->value();
+      if (!visitor({key.data(), key.size()}, {value.data(), value.size()})) {
+        break;
+      }
+      next->Next();
+    }
+
+    return std::all_of(iterators.begin(), iterators.end(), [](const auto& it) { return it->status().ok(); });
+  }
+
+  /// @brief Moves the records which were stored in the default family before their prefix got its own family
+  bool MoveToFamilies() {
+    std::unique_ptr<rocksdb::Iterator> it {db->NewIterator(rocksdb::ReadOptions(), db->DefaultColumnFamily())};
+    rocksdb::WriteBatch batch;
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+      const std::string_view key {it->key().data(), it->key().size()};
+      auto family = GetFamily(key);
+      if (family == db->DefaultColumnFamily()) {
+        continue;
+      }
+
+      batch.Put(family, it->key(), it->value());
+      batch.Delete(db->DefaultColumnFamily(), it->key());
+      // Keeps the batches small when a large database is opened for the first time
+      if (batch.Count() >= 1000) {
+        if (!db->Write(GetWriteOptions(true), &batch).ok()) {
+          return false;
+        }
+        batch.Clear();
+      }
+    }
+
+    return it->status().ok() && (batch.Count() == 0 || db->Write(GetWriteOptions(true), &batch).ok());
+  }
+
+  /// @brief LRU cache of uncompressed blocks
+  std::shared_ptr<rocksdb::Cache> block_cache;
+  /// @brief rocksdb database instance
+  rocksdb::DB* db;
+  /// @brief rocksdb database options
+  rocksdb::Options options;
+  /// @brief Handles of all the column families, including the default one
+  std::vector<rocksdb::ColumnFamilyHandle*> handles;
+  /// @brief Key prefix => column family
+  std::map<std::string, rocksdb::ColumnFamilyHandle*, std::less<>> families;
+};
+
+std::unique_ptr<Storage> OpenRocksDbStorage(const std::string& path, const StorageOptions& options) {
+  return std::make_unique<RocksDbStorage>(path, options);
+}
+} // namespace bs
@@ -0,0 +1,131 @@
+#include <charconv>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include "common.h"
+#include "encryption.h"
+#include "signature_verifier.h"
+
+namespace bs {
+using std::chrono::steady_clock;
+
+namespace {
+/// @brief Digest context which is reused by a thread
+struct DigestContext {
+  DigestContext() : ctx(EVP_MD_CTX_new()) {}
+  ~DigestContext() {
+    EVP_MD_CTX_free(ctx);
+  }
+
+  EVP_MD_CTX* ctx;
+};
+} // namespace
+
+SignatureVerifier& SignatureVerifier::GetInstance() {
+  static SignatureVerifier instance {app_config.kSlackSigningSecret};
+
+  return instance;
+}
+
+SignatureVerifier::SignatureVerifier(const std::string& secret)
+    : key(EVP_PKEY_new_raw_private_key(
+          EVP_PKEY_HMAC,
+          nullptr,
+          reinterpret_cast<const unsigned char*>(secret.data()),
+          secret.size()
+      )) {
+  if (key == nullptr) {
+    throw std::runtime_error("Unable to create HMAC key.");
+  }
+}
+
+SignatureVerifier::~SignatureVerifier() {
+  EVP_PKEY_free(key);
+}
+
+bool SignatureVerifier::Sign(std::string_view timestamp, std::string_view body, std::string* res) const {
+  static thread_local DigestContext digest_ctx;
+  EVP_MD_CTX* ctx = digest_ctx.ctx;
+  if (ctx == nullptr || !EVP_MD_CTX_reset(ctx)) {
+    return false;
+  }
+
+  unsigned char digest[EVP_MAX_MD_SIZE];
+  std::size_t digest_length = sizeof(digest);
+  if (EVP_DigestSignInit(ctx, nullptr, EVP_sha256(), nullptr, key) != 1
+      || EVP_DigestSignUpdate(ctx, "v0:", 3) != 1
+      || EVP_DigestSignUpdate(ctx, timestamp.data(), timestamp.size()) != 1
+      || EVP_DigestSignUpdate(ctx, ":", 1) != 1
+      || EVP_DigestSignUpdate(ctx, body.data(), body.size()) != 1
+      || EVP_DigestSignFinal(ctx, digest, &digest_length) != 1) {
+    return false;
+  }
+
+  *res = "v0=" + to_hex(digest, digest_length);
+
+  return true;
+}
+
+SignatureVerifier::Result SignatureVerifier::Verify(
+    std::string_view timestamp,
+    std::string_view body,
+    std::string_view signature,
+    std::time_t now
+) {
+  // A request which is not timestamped within the clock skew is rejected before hashing
+  long t = 0;
+  const auto [end, ec] = std::from_chars(timestamp.data(), timestamp.data() + timestamp.size(), t);
+  if (ec != std::errc() || end != timestamp.data() + timestamp.size() || std::labs(now - t) > kMaxClockSkew) {
+    return STALE;
+  }
+
+  std::string key;
+  key.reserve(timestamp.size() + 1 + signature.size());
+  key.append(timestamp).append(1, ':').append(signature);
+
+  {
+    std::lock_guard<std::mutex> lock {mutex};
+    Expire(steady_clock::now());
+    if (seen.count(key)) {
+      replayed++;
+
+      return REPLAYED;
+    }
+  }
+
+  std::string expected;
+  // A request which can not be verified is rejected
+  if (!Sign(timestamp, body, &expected)) {
+    return MISMATCH;
+  }
+  if (expected.size() != signature.size() || CRYPTO_memcmp(expected.data(), signature.data(), expected.size()) != 0) {
+    return MISMATCH;
+  }
+
+  std::lock_guard<std::mutex> lock {mutex};
+  // The same delivery may have been verified by another thread in the meantime
+  if (!seen.insert(key).second) {
+    replayed++;
+
+    return REPLAYED;
+  }
+  seen_order.emplace_back(steady_clock::now(), std::move(key));
+  if (seen_order.size() > kMaxReplayEntries) {
+    seen.erase(seen_order.front().second);
+    seen_order.pop_front();
+  }
+
+  return VALID;
+}
+
+void SignatureVerifier::Expire(steady_clock::time_point now) {
+  // A timestamp is accepted within the skew on both sides of the local clock
+  const auto window = std::chrono::seconds(2 * kMaxClockSkew);
+  while (!seen_order.empty() && now - seen_order.front().first > window) {
+    seen.erase(seen_order.front().second);
+    seen_order.pop_front();
+  }
+}
+} // namespace bs
@@ -0,0 +1,110 @@
+#include "json_reader.h"
+#include "slackapi.h"
+#include "slack_parser.h"
+
+namespace bs {
+/// @brief Helper function which reads a member of the users.list response
+/// @param reader A reader positioned at the member object
+/// @param accept An index of the user's emails to accept or nullptr to accept everyone
+/// @param users A list to add the member to
+static void ReadUsersListMember(JsonReader& reader, const EmailIndex* accept, SlackUsersList* users) {
+  UserProfile user {};
+  bool has_email = false;
+  bool deleted = false;
+  std::string key;
+
+  reader.BeginObject();
+  while (reader.NextKey(&key)) {
+    if (key == "id") {
+      user.slack_id = reader.ReadString();
+    } else if (key == "name") {
+      user.name = reader.ReadString();
+    } else if (key == "deleted") {
+      deleted = reader.ReadBool();
+    } else if (key == "tz_offset") {
+      user.tz_offset = reader.ReadNull() ? 0 : reader.ReadInteger();
+    } else if (key == "is_admin" || key == "is_owner" || key == "is_primary_owner") {
+      user.is_privileged = reader.ReadBool() || user.is_privileged;
+    } else if (key == "profile") {
+      reader.BeginObject();
+      while (reader.NextKey(&key)) {
+        if (key == "email") {
+          has_email = !reader.ReadNull();
+          if (has_email) {
+            user.email = reader.ReadString();
+          }
+        } else if (key == "real_name") {
+          user.real_name = reader.ReadStringOrNull();
+        } else if (key == "status_text") {
+          user.status_text = reader.ReadStringOrNull();
+        } else if (key == "status_emoji") {
+          user.status_emoji = reader.ReadStringOrNull();
+        } else if (key == "status_expiration") {
+          user.status_expiration = reader.ReadNull() ? 0 : reader.ReadInteger();
+        } else if (key == "status_text_canonical") {
+          user.status_text_canonical = reader.ReadStringOrNull();
+        } else {
+          reader.Skip();
+        }
+      }
+    } else {
+      reader.Skip();
+    }
+  }
+
+  // Bots and deleted users should be ignored
+  if (!has_email || deleted) {
+    return;
+  }
+
+  // Checks if the user's email exists in the accept list.
+  // If the user has been found its employee id is used as an adjustment.
+  if (accept != nullptr && !accept->Find(user.email, &user.bamboohr_employee_id)) {
+    // It does not exist
+    return;
+  }
+
+  users->push_back(std::move(user));
+}
+
+std::string ReadUsersListPage(std::string_view body, const EmailIndex* accept, SlackUsersList* users) {
+  JsonReader reader(body);
+  bool has_ok = false;
+  bool ok = false;
+  std::string error {"unspecified"};
+  std::string cursor;
+  std::string key;
+
+  reader.BeginObject();
+  while (reader.NextKey(&key)) {
+    if (key == "ok") {
+      has_ok = !reader.ReadNull();
+      ok = has_ok && reader.ReadBool();
+    } else if (key == "error") {
+      error = reader.ReadStringOrNull();
+    } else if (key == "members") {
+      reader.BeginArray();
+      while (reader.NextElement()) {
+        ReadUsersListMember(reader, accept, users);
+      }
+    } else if (key == "response_metadata" && !reader.ReadNull()) {
+      reader.BeginObject();
+      while (reader.NextKey(&key)) {
+        if (key == "next_cursor") {
+          cursor = reader.ReadStringOrNull();
+        } else {
+          reader.Skip();
+        }
+      }
+    } else if (key != "response_metadata") {
+      reader.Skip();
+    }
+  }
+
+  if (!has_ok || !ok) {
+    throw SlackApiError("Slack API responded with error: " + error);
+  }
+
+  return cursor;
+}
+} // namespace bs
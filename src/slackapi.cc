@@ -1,4 +1,8 @@
 #include "base64.h"
+#include "email_index.h"
+#include "http_client_pool.h"
+#include "rate_limiter.h"
+#include "slack_parser.h"
 #include "slackapi.h"
 
 using namespace web;
@@ -23,18 +27,78 @@ static void GetHeaderScopes(
   }
 }
 
-json::value SlackApiClient::SendRequest(
+/// @brief Helper function which checks the status of Slack API response
+/// @param response A response to check
+static void CheckResponseStatus(const http_response& response) {
+  if (response.status_code() != 200) {
+    throw std::runtime_error("Slack API error: " + response.to_string());
+  }
+}
+
+/// @brief Helper function which checks the JSON body of Slack API response
+/// @param result A response body to check
+/// @returns The body of the successful response
+static json::value CheckResponseBody(json::value result) {
+  const bool no_ok = result.at(U("ok")).is_null();
+
+  if (no_ok || !no_ok && result["ok"].as_bool() == false) {
+    throw SlackApiError(
+        "Slack API responded with error: "
+        + (!result.at(U("error")).is_null() ? result["error"].as_string() : "unspecified")
+    );
+  }
+
+  return result;
+}
+
+/// @brief Helper function which checks Slack API response and extracts its JSON body.
+/// The calling thread is blocked until the body is read.
+/// @param response A response to check
+/// @returns A JSON body of the successful response
+static json::value ParseResponse(http_response& response) {
+  CheckResponseStatus(response);
+
+  return CheckResponseBody(response.extract_json().get());
+}
+
+/// @brief Helper function which creates users.profile.set request body
+/// @param slack_id Slack user identifier
+/// @param to_profile time off profile to set
+/// @param status_expiration status expiration to set
+static json::value ProfileSetStatusBody(
+    const std::string& slack_id,
+    const TimeOffProfile& to_profile,
+    const uint64_t& status_expiration
+) {
+  json::value req;
+  const std::string pr = U("profile");
+
+  req[U("user")] = json::value::string(slack_id);
+  req[pr][U("status_text")] = json::value::string(to_profile.text);
+  req[pr][U("status_emoji")] = json::value::string(to_profile.emoji);
+  req[pr][U("status_text_canonical")] = json::value::string(to_profile.text_canonical);
+  req[pr][U("status_expiration")] = json::value::number(status_expiration);
+
+  return req;
+}
+
+/// @brief Helper function which creates an authorized API request
+/// @param token API token
+/// @param mtd HTTP method
+/// @param uri Request URI
+/// @param json_v JSON is being used in POST HTTP requests
+static http_request BuildRequest(
+    const std::string& token,
     const method& mtd,
     const std::string& uri,
     const json::value& json_v
 ) {
-  client::http_client client(kApiUrl);
   http_request req(mtd);
 
   req.headers().add(U("User-Agent"), GetUserAgent());
   req.headers().add(U("Accept-Charset"), U("utf-8"));
   // It uses bearer API token
-  req.headers().add(U("Authorization"), U("Bearer " + kApiToken));
+  req.headers().add(U("Authorization"), U("Bearer " + token));
 
   if (mtd == methods::POST) {
     req.headers().add(U("Content-Type"), U("application/json; charset=utf-8"));
@@ -48,33 +112,111 @@ json::value SlackApiClient::SendRequest(
 
   req.set_request_uri(uri);
 
-  http_response response = client.request(req).get();
+  return req;
+}
+
+/// @brief Helper function which gets a delay from the Retry-After header of a throttled response
+/// @param response HTTP 429 response
+static std::chrono::seconds GetRetryAfter(const http_response& response) {
+  if (const auto& it {response.headers().find(U("Retry-After"))}; it != response.headers().end()) {
+    try {
+      return std::chrono::seconds(std::stoi(it->second));
+    } catch (...) {
+      // Falls back to the default delay
+    }
+  }
+
+  return std::chrono::seconds(1);
+}
+
+/// @brief Helper function which sends a request asynchronously retrying it while it's throttled
+/// @param token API token
+/// @param mtd HTTP method
+/// @param uri Request URI
+/// @param json_v JSON is being used in POST HTTP requests
+/// @param attempt How many times the request has already been retried
+static pplx::task<json::value> SendPacedAsync(
+    const std::string& token,
+    const method& mtd,
+    const std::string& uri,
+    const json::value& json_v,
+    const unsigned int attempt
+) {
+  auto& limiter = SlackRateLimiter::GetInstance();
+  const std::string api_method = SlackRateLimiter::ApiMethod(uri);
+
+  // The request waits for the bucket without holding a task pool thread
+  return limiter.AcquireAsync(token, api_method)
+      .then([=]() {
+        return HttpClientPool::GetInstance().Request(SlackApiClient::kApiUrl, BuildRequest(token, mtd, uri, json_v));
+      })
+      .then([=, &limiter](http_response response) {
+        if (response.status_code() == SlackApiClient::kTooManyRequests
+            && limiter.OnThrottled(token, api_method, GetRetryAfter(response), attempt)) {
+          // The retry is paced by the limiter until Retry-After has passed
+          return SendPacedAsync(token, mtd, uri, json_v, attempt + 1);
+        }
+
+        CheckResponseStatus(response);
+
+        // The body is checked by a continuation, so no task pool thread waits for it
+        return response.extract_json().then([](json::value result) {
+          return CheckResponseBody(std::move(result));
+        });
+      });
+}
+
+http_response SlackApiClient::SendRaw(
+    const method& mtd,
+    const std::string& uri,
+    const json::value& json_v
+) {
+  auto& limiter = SlackRateLimiter::GetInstance();
+  const std::string api_method = SlackRateLimiter::ApiMethod(uri);
+  http_response response;
+
+  for (unsigned int attempt = 0; ; ++attempt) {
+    limiter.Acquire(kApiToken, api_method);
+
+    response = HttpClientPool::GetInstance().Request(kApiUrl, BuildRequest(kApiToken, mtd, uri, json_v)).get();
+
+    if (response.status_code() != kTooManyRequests
+        || !limiter.OnThrottled(kApiToken, api_method, GetRetryAfter(response), attempt)) {
+      break;
+    }
+  }
 
   // Stores available OAuth scopes for the token
   GetHeaderScopes(oauth_scopes, response.headers(), U("X-OAuth-Scopes"));
   // Stores accepted OAuth scopes for the API request
   GetHeaderScopes(accepted_oauth_scopes, response.headers(), U("X-Accepted-OAuth-Scopes"));
 
-  if (response.status_code() != 200) {
-    throw std::runtime_error("Slack API error: " + response.to_string());
-  }
+  return response;
+}
 
-  json::value result = response.extract_json().get();
-  const bool no_ok = result.at(U("ok")).is_null();
+json::value SlackApiClient::SendRequest(
+    const method& mtd,
+    const std::string& uri,
+    const json::value& json_v
+) {
+  http_response response = SendRaw(mtd, uri, json_v);
 
-  if (no_ok || !no_ok && result["ok"].as_bool() == false) {
-    throw SlackApiError(
-        "Slack API responded with error: "
-        + (!result.at(U("error")).is_null() ? result["error"].as_string() : "unspecified")
-    );
-  }
+  return ParseResponse(response);
+}
 
-  return result;
+pplx::task<json::value> SlackApiClient::SendRequestAsync(
+    const method& mtd,
+    const std::string& uri,
+    const json::value& json_v
+) const {
+  return SendPacedAsync(kApiToken, mtd, uri, json_v, 0);
 }
 
 SlackUsersList SlackApiClient::UsersList(const BambooHrUsersList& accept) {
-  int bamboohr_employee_id = 0;
   SlackUsersList users;
+  // Joins Slack members to BambooHR employees by email
+  const EmailIndex index(accept);
+  const EmailIndex* accept_index = kDefaultAccept != accept ? &index : nullptr;
 
   std::string cursor {""};
 
@@ -86,60 +228,17 @@ SlackUsersList SlackApiClient::UsersList(const BambooHrUsersList& accept) {
       builder.append_query(U("cursor"), cursor);
     }
 
-    json::value json_response = SendRequest(methods::GET, builder.to_string());
-
-    auto array = json_response.at(U("members")).as_array();
-
-    for (int i = 0; i < array.size(); ++i) {
-      auto& profileValue = array[i].at(U("profile"));
-      const json::value& emailValue = profileValue[U("email")];
-
-      // Bots and deleted users should be ignored
-      if (emailValue.is_null()
-          || true == array[i].at(U("deleted")).as_bool()
-          ) {
-        continue;
-      }
+    http_response response = SendRaw(methods::GET, builder.to_string());
 
-      std::string email = emailValue.as_string();
-
-      if (kDefaultAccept != accept) {
-        // Checks if the user's email exists in the accept list
-        auto iter = accept.find(email);
-        if (iter == accept.end()) {
-          // It does not exist
-          continue;
-        }
-
-        // User has been found.
-        // Use its employee id as an adjustment
-        bamboohr_employee_id = iter->second;
-      } else {
-        bamboohr_employee_id = 0;
-      }
-
-      users[email] = {
-          array[i].at(U("id")).as_string(),
-          email,
-          array[i].at(U("name")).as_string(),
-          profileValue[U("real_name")].as_string(),
-          profileValue[U("status_text")].as_string(),
-          profileValue[U("status_emoji")].as_string(),
-          profileValue[U("status_expiration")].as_integer(),
-          profileValue[U("status_text_canonical")].as_string(),
-          bamboohr_employee_id,
-          array[i].at(U("tz_offset")).as_integer(),
-          array[i].at(U("is_admin")).as_bool()
-              || array[i].at(U("is_owner")).as_bool()
-              || array[i].at(U("is_primary_owner")).as_bool()
-      };
+    if (response.status_code() != 200) {
+      throw std::runtime_error("Slack API error: " + response.to_string());
     }
 
-    // Check if there is a next page
-    cursor = !json_response.at(U("response_metadata")).is_null()
-                 && !json_response.at(U("response_metadata")).at(U("next_cursor")).is_null()
-             ? json_response.at(U("response_metadata")).at(U("next_cursor")).as_string()
-             : "";
+    // Pages contain up to 1000 full profiles, so instead of building a DOM
+    // only the fields of UserProfile are picked from the raw body.
+    const std::string body = response.extract_utf8string(true).get();
+
+    cursor = ReadUsersListPage(body, accept_index, &users);
   } while (cursor != "");
 
   return users;
@@ -150,19 +249,24 @@ void SlackApiClient::UsersProfileSetStatus(
     const TimeOffProfile& to_profile,
     const uint64_t& status_expiration
 ) {
-  json::value req;
-  const std::string pr = U("profile");
-
   // Build request URI and start the request.
   uri_builder builder(U("/api/users.profile.set"));
 
-  req[U("user")] = json::value::string(slack_id);
-  req[pr][U("status_text")] = json::value::string(to_profile.text);
-  req[pr][U("status_emoji")] = json::value::string(to_profile.emoji);
-  req[pr][U("status_text_canonical")] = json::value::string(to_profile.text_canonical);
-  req[pr][U("status_expiration")] = json::value::number(status_expiration);
+  SendRequest(methods::POST, builder.to_string(), ProfileSetStatusBody(slack_id, to_profile, status_expiration));
+}
+
+pplx::task<void> SlackApiClient::UsersProfileSetStatusAsync(
+    const std::string& slack_id,
+    const TimeOffProfile& to_profile,
+    const uint64_t& status_expiration
+) const {
+  uri_builder builder(U("/api/users.profile.set"));
 
-  SendRequest(methods::POST, builder.to_string(), req);
+  return SendRequestAsync(
+      methods::POST,
+      builder.to_string(),
+      ProfileSetStatusBody(slack_id, to_profile, status_expiration)
+  ).then([](const json::value&) {});
 }
 
 json::value SlackApiClient::UsersInfo(const std::string& user_id) {
@@ -177,7 +281,6 @@ json::value SlackApiClient::OauthAccess(
     const std::string& client_secret,
     const std::string& code
 ) {
-  client::http_client client(kApiUrl);
   http_request req(methods::POST);
 
   req.headers().add(U("User-Agent"), GetUserAgent());
@@ -192,7 +295,7 @@ json::value SlackApiClient::OauthAccess(
       "application/x-www-form-urlencoded"
   );
 
-  http_response response = client.request(req).get();
+  http_response response = HttpClientPool::GetInstance().Request(kApiUrl, req).get();
 
   if (response.status_code() != 200) {
     throw std::runtime_error(
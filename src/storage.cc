@@ -0,0 +1,30 @@
+#include <stdexcept>
+#include "storage.h"
+
+namespace bs {
+bool IsStorageAvailable(const std::string& backend) {
+#ifdef BS_WITH_ROCKSDB
+  if (backend == kStorageRocksDb) {
+    return true;
+  }
+#endif
+
+  return backend == kStorageLevelDb || backend == kStorageMemory;
+}
+
+std::unique_ptr<Storage> OpenStorage(const std::string& backend, const std::string& path, const StorageOptions& options) {
+  if (backend == kStorageLevelDb) {
+    return OpenLevelDbStorage(path, options);
+  }
+  if (backend == kStorageMemory) {
+    return OpenMemoryStorage();
+  }
+#ifdef BS_WITH_ROCKSDB
+  if (backend == kStorageRocksDb) {
+    return OpenRocksDbStorage(path, options);
+  }
+#endif
+
+  throw std::runtime_error("Unsupported storage backend " + backend);
+}
+} // namespace bs
@@ -19,34 +19,86 @@ static int hex_char_digit_to_decimal_char(int hex) {
   return decimal;
 }
 
-template<class String>
-static std::string decode_template(const String& encoded) {
-  std::string raw;
-  for (auto iter = encoded.begin(); iter != encoded.end(); ++iter) {
-    if (*iter == '%') {
-      if (++iter == encoded.end()) {
+/// @brief Decodes the range of the string in place.
+/// @returns The new end of the decoded range
+/// @throws uri_exception if the range is not a valid encoded ASCII string
+static char* decode_in_place(char* first, char* last) {
+  auto out = first;
+  for (auto iter = first; iter != last; ++iter, ++out) {
+    const char c = *iter;
+    if (c == '%') {
+      if (last - iter < 3) {
         throw web::uri_exception("Invalid URI string, two hexadecimal digits must follow '%'");
       }
-      int decimal_value = hex_char_digit_to_decimal_char(static_cast<int>(*iter)) << 4;
-      if (++iter == encoded.end()) {
-        throw web::uri_exception("Invalid URI string, two hexadecimal digits must follow '%'");
-      }
-      decimal_value += hex_char_digit_to_decimal_char(static_cast<int>(*iter));
-
-      raw.push_back(static_cast<char>(decimal_value));
-    } else if (*iter > 127 || *iter < 0) {
+      int decimal_value = hex_char_digit_to_decimal_char(static_cast<int>(iter[1])) << 4;
+      decimal_value += hex_char_digit_to_decimal_char(static_cast<int>(iter[2]));
+      iter += 2;
+      *out = static_cast<char>(decimal_value);
+    } else if (static_cast<unsigned char>(c) > 127) {
       throw web::uri_exception("Invalid encoded URI string, must be entirely ascii");
-    } else if (*iter == '+') {
-      raw.push_back(' ');
-    } else {
-      // encoded string has to be ASCII.
-      raw.push_back(static_cast<char>(*iter));
+    } else if (c == '+') {
+      *out = ' ';
+    } else if (out != iter) {
+      // Shifts the rest of the string only after the first escape sequence
+      *out = c;
     }
   }
-  return raw;
+  return out;
 }
 
 // We have to override uri::decode method as it does not decode "+" as a space character
 utility::string_t url_decode(const utility::string_t& encoded) {
-  return utility::conversions::to_string_t(decode_template(encoded));
-}
\ No newline at end of file
+  std::string raw {utility::conversions::to_utf8string(encoded)};
+  raw.resize(decode_in_place(raw.data(), raw.data() + raw.size()) - raw.data());
+  return utility::conversions::to_string_t(std::move(raw));
+}
+
+FormData::FormData(std::string&& encoded) : text(std::move(encoded)) {
+  // Each '&' separates at most one more field
+  std::size_t count = 1;
+  for (const char c : text) {
+    count += c == '&';
+  }
+  fields.reserve(count);
+
+  std::size_t pos = 0;
+  while (pos <= text.size()) {
+    auto end = text.find('&', pos);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    if (end != pos) {
+      auto eq = text.find('=', pos);
+      if (eq == std::string::npos || eq > end) {
+        eq = end;
+      }
+      auto name = Decode(pos, eq);
+      auto value = eq < end ? Decode(eq + 1, end) : std::string_view();
+      fields.emplace_back(name, value);
+    }
+    pos = end + 1;
+  }
+}
+
+std::string_view FormData::Decode(std::size_t begin, std::size_t end) {
+  auto first = text.data() + begin;
+  return std::string_view(first, decode_in_place(first, text.data() + end) - first);
+}
+
+std::string_view FormData::Get(std::string_view name) const {
+  for (const auto& field : fields) {
+    if (field.first == name) {
+      return field.second;
+    }
+  }
+  return std::string_view();
+}
+
+bool FormData::Has(std::string_view name) const {
+  for (const auto& field : fields) {
+    if (field.first == name) {
+      return true;
+    }
+  }
+  return false;
+}
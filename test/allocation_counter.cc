@@ -0,0 +1,85 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+#include <sys/resource.h>
+#include "allocation_counter.h"
+
+namespace {
+std::atomic<uint64_t> allocations {0};
+/// @brief Bytes in use. It's signed, since the blocks allocated before the reset may be freed after it.
+std::atomic<int64_t> in_use {0};
+std::atomic<int64_t> peak {0};
+/// @brief Bytes which were in use at the reset
+std::atomic<int64_t> base {0};
+
+void* Allocate(std::size_t size) {
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  const int64_t size_in_use = malloc_usable_size(ptr);
+  const int64_t now = in_use.fetch_add(size_in_use, std::memory_order_relaxed) + size_in_use;
+  int64_t max = peak.load(std::memory_order_relaxed);
+  while (now > max && !peak.compare_exchange_weak(max, now, std::memory_order_relaxed)) {
+  }
+
+  return ptr;
+}
+
+void Free(void* ptr) {
+  if (ptr != nullptr) {
+    in_use.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+    std::free(ptr);
+  }
+}
+} // namespace
+
+void* operator new(std::size_t size) {
+  return Allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return Allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  Free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  Free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  Free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  Free(ptr);
+}
+
+namespace allocation_counter {
+void Reset() {
+  allocations = 0;
+  base = in_use.load();
+  peak = base.load();
+}
+
+uint64_t Allocations() {
+  return allocations;
+}
+
+uint64_t PeakBytes() {
+  return static_cast<uint64_t>(peak - base);
+}
+
+int64_t MaxRssKb() {
+  rusage usage {};
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_maxrss;
+}
+} // namespace allocation_counter
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <benchmark/benchmark.h>
+
+/// @brief Counts the heap allocations of the benchmarks. The global operator new and delete are replaced
+/// by allocation_counter.cc, so every allocation of the process is counted, including the ones of the libraries.
+namespace allocation_counter {
+/// @brief Starts counting from zero. The peak is measured from the bytes which are in use at the moment.
+void Reset();
+
+/// @brief Gets the number of allocations since the reset
+uint64_t Allocations();
+
+/// @brief Gets the most bytes which have been in use at once since the reset
+uint64_t PeakBytes();
+
+/// @brief Gets the peak resident set size of the process (kilobytes). It never goes down, so benchmarks
+/// which are compared by it should be run in separate processes with --benchmark_filter.
+int64_t MaxRssKb();
+
+/// @brief Reports the allocations per iteration and the peak memory of the benchmark since the reset
+inline void Report(benchmark::State& state) {
+  state.counters["allocs"] = benchmark::Counter(static_cast<double>(Allocations()), benchmark::Counter::kAvgIterations);
+  state.counters["peak_bytes"] = static_cast<double>(PeakBytes());
+  state.counters["max_rss_kb"] = static_cast<double>(MaxRssKb());
+}
+} // namespace allocation_counter
@@ -0,0 +1,90 @@
+#include <string>
+#include <benchmark/benchmark.h>
+#include <cpprest/json.h>
+#include "allocation_counter.h"
+#include "bamboohr_parser.h"
+#include "bamboohrapi_legacy.h"
+#include "fixture.h"
+
+using web::json::value;
+
+/// @brief The period the time-off requests are recorded for
+static const int32_t kStartDay {bs::strtodays("2021-03-08")};
+static const int32_t kEndDay {bs::strtodays("2021-03-12")};
+
+/// @brief Builds a meta/users response of the size by repeating the recorded users with unique IDs and emails
+static value MetaUsers(std::size_t size) {
+  const value recorded = value::parse(ReadFixture("bamboohr_meta_users.json"));
+  const auto& users = recorded.as_object();
+  value response = value::object();
+  for (std::size_t i = 0; i < size; ++i) {
+    value user = (users.begin() + i % users.size())->second;
+    user[U("id")] = value::number(static_cast<int32_t>(i));
+    user[U("employeeId")] = value::number(static_cast<int32_t>(i));
+    user[U("email")] = value::string("user" + std::to_string(i) + "@example.com");
+    response[std::to_string(i)] = std::move(user);
+  }
+
+  return response;
+}
+
+/// @brief Builds a time_off/requests response of the size by repeating the recorded requests for other employees
+static value TimeOffRequests(std::size_t size) {
+  const value recorded = value::parse(ReadFixture("bamboohr_time_off_requests.json"));
+  const auto& requests = recorded.as_array();
+  value response = value::array(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    value request = requests.at(i % requests.size());
+    request[U("id")] = value::string(std::to_string(i));
+    request[U("employeeId")] = value::string(std::to_string(i / requests.size()));
+    response[i] = std::move(request);
+  }
+
+  return response;
+}
+
+static void BM_ParseUsersList(benchmark::State& state) {
+  const value response {MetaUsers(state.range(0))};
+  allocation_counter::Reset();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bs::ParseUsersList(response));
+  }
+  allocation_counter::Report(state);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_LegacyParseUsersList(benchmark::State& state) {
+  const value response {MetaUsers(state.range(0))};
+  allocation_counter::Reset();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacy::ParseUsersList(response));
+  }
+  allocation_counter::Report(state);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_ParseTimeOffRequests(benchmark::State& state) {
+  const value response {TimeOffRequests(state.range(0))};
+  allocation_counter::Reset();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bs::ParseTimeOffRequests(response, kStartDay, kEndDay));
+  }
+  allocation_counter::Report(state);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_LegacyParseTimeOffRequests(benchmark::State& state) {
+  const value response {TimeOffRequests(state.range(0))};
+  allocation_counter::Reset();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacy::ParseTimeOffRequests(response, kStartDay, kEndDay));
+  }
+  allocation_counter::Report(state);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// A small organization and a large one
+BENCHMARK(BM_ParseUsersList)->Arg(100)->Arg(5000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LegacyParseUsersList)->Arg(100)->Arg(5000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_ParseTimeOffRequests)->Arg(100)->Arg(5000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_LegacyParseTimeOffRequests)->Arg(100)->Arg(5000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <cpprest/json.h>
+#include "common.h"
+
+/// @brief The BambooHR response readers as they were before they read the shared response by reference.
+/// They copy the same subtrees the former code did and fill the current result types, so the benchmarks
+/// measure the copies alone. They are kept as the reference for the benchmarks.
+namespace legacy {
+inline bs::BambooHrUsersList ParseUsersList(const web::json::value& response) {
+  bs::BambooHrUsersList users;
+  // Cache hits used to return a copy of the cached response
+  web::json::value json_response = response;
+
+  auto object = json_response.as_object();
+
+  for (auto i = object.begin(); i != object.end(); i++) {
+    // Ignoring fired employees
+    if (U("enabled") != i->second.at(U("status")).as_string())
+      continue;
+
+    users[i->second.at(U("email")).as_string()] = i->second.at(U("employeeId")).as_integer();
+  }
+
+  return users;
+}
+
+inline bs::BambooHrTimeOffList ParseTimeOffRequests(
+    const web::json::value& response,
+    int32_t start_day,
+    int32_t end_day
+) {
+  bs::BambooHrTimeOffList ret;
+  // Cache hits used to return a copy of the cached response
+  web::json::value json_response = response;
+
+  auto array = json_response.as_array();
+
+  for (std::size_t i = 0; i < array.size(); ++i) {
+    auto employee_id = std::stoi(array[i].at(U("employeeId")).as_string());
+    auto timeoff_type = array[i].at(U("type"))[U("name")].as_string();
+    auto dates = array[i].at(U("dates")).as_object();
+    // Pick only dates where time off is active in the specified period
+    for (auto v = std::begin(dates); v != std::end(dates); v++) {
+      const int32_t day = bs::strtodays(v->first);
+      if (start_day <= day && day <= end_day) {
+        ret.Add(employee_id, day, timeoff_type);
+      }
+    }
+  }
+
+  ret.Sort();
+
+  return ret;
+}
+} // namespace legacy
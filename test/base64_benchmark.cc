@@ -0,0 +1,55 @@
+#include <random>
+#include <string>
+#include <benchmark/benchmark.h>
+#include "base64.h"
+#include "base64_legacy.h"
+
+/// @brief Generates random bytes. The seed is fixed, so runs are comparable.
+static std::string RandomBytes(std::size_t size) {
+  std::mt19937 rng {20211017};
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::string data(size, '\0');
+  for (auto& c : data) {
+    c = static_cast<char>(byte(rng));
+  }
+
+  return data;
+}
+
+static void BM_Encode(benchmark::State& state) {
+  const std::string data {RandomBytes(state.range(0))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base64_encode(data));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void BM_LegacyEncode(benchmark::State& state) {
+  const std::string data {RandomBytes(state.range(0))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacy::base64_encode(data));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void BM_Decode(benchmark::State& state) {
+  const std::string encoded {base64_encode(RandomBytes(state.range(0)))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(base64_decode(encoded));
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+
+static void BM_LegacyDecode(benchmark::State& state) {
+  const std::string encoded {base64_encode(RandomBytes(state.range(0)))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacy::base64_decode(encoded));
+  }
+  state.SetBytesProcessed(state.iterations() * encoded.size());
+}
+
+// From an auth header and a small record up to a large cached response
+BENCHMARK(BM_Encode)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK(BM_LegacyEncode)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK(BM_Decode)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK(BM_LegacyDecode)->RangeMultiplier(16)->Range(64, 1 << 20);
@@ -0,0 +1,81 @@
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "test.h"
+#include "base64.h"
+#include "base64_legacy.h"
+
+/// @brief Generates random bytes
+static std::string RandomBytes(std::mt19937& rng, std::size_t size) {
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::string data(size, '\0');
+  for (auto& c : data) {
+    c = static_cast<char>(byte(rng));
+  }
+
+  return data;
+}
+
+/// @brief Decodes with both codecs and checks that they agree, including on errors
+static void ExpectSameDecode(const std::string& encoded) {
+  std::string expected;
+  try {
+    expected = legacy::base64_decode(encoded);
+  } catch (std::invalid_argument&) {
+    EXPECT_THROW(base64_decode(encoded), std::invalid_argument) << "Encoded: " << encoded;
+    return;
+  }
+  EXPECT_EQ(base64_decode(encoded), expected) << "Encoded: " << encoded;
+}
+
+TEST(Base64Test, KnownVectors) {
+  EXPECT_EQ(base64_encode(""), "");
+  EXPECT_EQ(base64_encode("f"), "Zg==");
+  EXPECT_EQ(base64_encode("fo"), "Zm8=");
+  EXPECT_EQ(base64_encode("foo"), "Zm9v");
+  EXPECT_EQ(base64_encode("foobar"), "Zm9vYmFy");
+  EXPECT_EQ(base64_decode(""), "");
+  EXPECT_EQ(base64_decode("Zm9vYmFy"), "foobar");
+  EXPECT_EQ(base64_decode("Zm9v\nYg=="), "foob");
+}
+
+TEST(Base64Test, RejectsIllegalCharacters) {
+  EXPECT_THROW(base64_decode("Zm9v*mFy"), std::invalid_argument);
+  EXPECT_THROW(base64_decode("Zm9vYmFyZm9vYmFyZm9vYmF\xc3\xa9"), std::invalid_argument);
+}
+
+TEST(Base64Test, RoundTripMatchesLegacy) {
+  std::mt19937 rng {20211017};
+
+  // The sizes cover the scalar tail after every number of vector blocks. Empty input is excluded,
+  // since the legacy encoder asserts on it.
+  for (std::size_t size = 1; size <= 256; ++size) {
+    for (int i = 0; i < 64; ++i) {
+      const std::string data {RandomBytes(rng, size)};
+      const std::string encoded {base64_encode(data)};
+
+      ASSERT_EQ(encoded, legacy::base64_encode(data)) << "Size: " << size;
+      ASSERT_EQ(base64_decode(encoded), data) << "Size: " << size;
+      ASSERT_EQ(legacy::base64_decode(encoded), data) << "Size: " << size;
+    }
+  }
+}
+
+TEST(Base64Test, DecodeOfMutatedInputMatchesLegacy) {
+  std::mt19937 rng {20211018};
+  // Padding, whitespaces and invalid characters make the vector decoder fall back to the scalar one
+  static const std::string replacements {"=\n \t*-_.\x80\xff" "A/+"};
+  std::uniform_int_distribution<std::size_t> size(1, 200);
+  std::uniform_int_distribution<std::size_t> pick(0, replacements.size() - 1);
+
+  for (int i = 0; i < 20000; ++i) {
+    std::string encoded {base64_encode(RandomBytes(rng, size(rng)))};
+    std::uniform_int_distribution<std::size_t> pos(0, encoded.size() - 1);
+    const int mutations = i % 4;
+    for (int m = 0; m < mutations; ++m) {
+      encoded[pos(rng)] = replacements[pick(rng)];
+    }
+
+    ExpectSameDecode(encoded);
+  }
+}
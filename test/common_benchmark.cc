@@ -0,0 +1,60 @@
+#include <regex>
+#include <string>
+#include <benchmark/benchmark.h>
+#include "common.h"
+
+/// @brief Fields of a slash command request which are validated
+static const std::string kTeamId {"T0123456789"};
+static const std::string kUserId {"U0123456789"};
+static const std::string kTriggerId {"1234567890123.1234567890.0123456789abcdef0123456789abcdef"};
+static const std::string kResponseUrl {"https://hooks.slack.com/commands/T0123456789/1234567890123/0123456789abcdefABCDEFGH"};
+static const std::string kOrg {"acme_corp"};
+static const std::string kSecret {"0123456789abcdef0123456789abcdef01234567"};
+
+static void BM_Validators(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        bs::IsAlphanum(kTeamId) && bs::IsAlphanum(kUserId) && bs::IsTriggerId(kTriggerId)
+        && bs::IsHttpsUrl(kResponseUrl) && bs::IsWord(kOrg) && bs::IsHexString(kSecret, 40)
+    );
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// @brief The former validation. Only the alphanum and word expressions were compiled once.
+static void BM_Regex(benchmark::State& state) {
+  static const std::regex alphanum {"[a-z0-9]+", std::regex::icase};
+  static const std::regex word {"[a-z][a-z0-9_]+", std::regex::icase};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        std::regex_match(kTeamId, alphanum) && std::regex_match(kUserId, alphanum)
+        && std::regex_match(kTriggerId, std::regex("[a-z0-9_\\.]+", std::regex::icase))
+        && std::regex_match(kResponseUrl, std::regex("^https://.+"))
+        && std::regex_match(kOrg, word)
+        && std::regex_match(kSecret, std::regex("[a-f0-9]{40,}", std::regex::icase))
+    );
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// @brief The former expressions compiled once, so only the matching is measured
+static void BM_RegexPrecompiled(benchmark::State& state) {
+  static const std::regex alphanum {"[a-z0-9]+", std::regex::icase};
+  static const std::regex word {"[a-z][a-z0-9_]+", std::regex::icase};
+  static const std::regex trigger_id {"[a-z0-9_\\.]+", std::regex::icase};
+  static const std::regex https_url {"^https://.+"};
+  static const std::regex hex {"[a-f0-9]{40,}", std::regex::icase};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        std::regex_match(kTeamId, alphanum) && std::regex_match(kUserId, alphanum)
+        && std::regex_match(kTriggerId, trigger_id) && std::regex_match(kResponseUrl, https_url)
+        && std::regex_match(kOrg, word) && std::regex_match(kSecret, hex)
+    );
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Every benchmark validates all the fields of one request
+BENCHMARK(BM_Validators);
+BENCHMARK(BM_Regex);
+BENCHMARK(BM_RegexPrecompiled);
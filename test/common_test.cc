@@ -0,0 +1,162 @@
+#include <ctime>
+#include <random>
+#include <regex>
+#include <string>
+#include "test.h"
+#include "common.h"
+
+using namespace bs;
+
+TEST(ValidatorsTest, IsAlphanum) {
+  EXPECT_TRUE(IsAlphanum("T0123ABC"));
+  EXPECT_TRUE(IsAlphanum("u1"));
+  EXPECT_FALSE(IsAlphanum(""));
+  EXPECT_FALSE(IsAlphanum("T 1"));
+  EXPECT_FALSE(IsAlphanum("T_1"));
+  EXPECT_FALSE(IsAlphanum("T\xc3\xa9"));
+}
+
+TEST(ValidatorsTest, IsWord) {
+  EXPECT_TRUE(IsWord("my_org1"));
+  EXPECT_TRUE(IsWord("Ab"));
+  EXPECT_FALSE(IsWord(""));
+  EXPECT_FALSE(IsWord("a"));
+  EXPECT_FALSE(IsWord("_org"));
+  EXPECT_FALSE(IsWord("1org"));
+  EXPECT_FALSE(IsWord("my-org"));
+}
+
+TEST(ValidatorsTest, IsTriggerId) {
+  EXPECT_TRUE(IsTriggerId("13345224609.738474920.8088930838d88f008e0"));
+  EXPECT_TRUE(IsTriggerId("a_b"));
+  EXPECT_FALSE(IsTriggerId(""));
+  EXPECT_FALSE(IsTriggerId("1/2"));
+  EXPECT_FALSE(IsTriggerId("1 2"));
+}
+
+TEST(ValidatorsTest, IsHexString) {
+  EXPECT_TRUE(IsHexString("0123456789abcdefABCDEF0123456789abcdefAB", 40));
+  EXPECT_TRUE(IsHexString("", 0));
+  EXPECT_FALSE(IsHexString("0123456789abcdefABCDEF0123456789abcdefA", 40));
+  EXPECT_FALSE(IsHexString("0123456789abcdefABCDEF0123456789abcdefAg", 40));
+}
+
+TEST(ValidatorsTest, IsHttpsUrl) {
+  EXPECT_TRUE(IsHttpsUrl("https://hooks.slack.com/commands/T1/2/x"));
+  EXPECT_FALSE(IsHttpsUrl("https://"));
+  EXPECT_FALSE(IsHttpsUrl("http://hooks.slack.com"));
+  EXPECT_FALSE(IsHttpsUrl("HTTPS://hooks.slack.com"));
+  EXPECT_FALSE(IsHttpsUrl(" https://hooks.slack.com"));
+  EXPECT_FALSE(IsHttpsUrl("https://hooks.slack.com\r\nHost: evil"));
+}
+
+TEST(ValidatorsTest, MatchRegularExpressions) {
+  // These are the expressions the validators replaced
+  const std::regex alphanum {"[a-z0-9]+", std::regex::icase};
+  const std::regex word {"[a-z][a-z0-9_]+", std::regex::icase};
+  const std::regex trigger_id {"[a-z0-9_\\.]+", std::regex::icase};
+  const std::regex hex {"[a-f0-9]{4,}", std::regex::icase};
+  const std::regex https_url {"^https://.+"};
+
+  static const std::string alphabet {"aZf0G9_./: \n\r\x80"};
+  std::mt19937 rng {20211017};
+  std::uniform_int_distribution<std::size_t> length(0, 8);
+  std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+
+  for (int i = 0; i < 50000; ++i) {
+    std::string s(length(rng), ' ');
+    for (auto& c : s) {
+      c = alphabet[pick(rng)];
+    }
+    const std::string url {(i % 2 ? "https://" : "") + s};
+
+    ASSERT_EQ(IsAlphanum(s), std::regex_match(s, alphanum)) << s;
+    ASSERT_EQ(IsWord(s), std::regex_match(s, word)) << s;
+    ASSERT_EQ(IsTriggerId(s), std::regex_match(s, trigger_id)) << s;
+    ASSERT_EQ(IsHexString(s, 4), std::regex_match(s, hex)) << s;
+    ASSERT_EQ(IsHttpsUrl(url), std::regex_match(url, https_url)) << url;
+  }
+}
+
+TEST(DaysTest, StrToDays) {
+  EXPECT_EQ(strtodays("1970-01-01"), 0);
+  EXPECT_EQ(strtodays("1970-01-02"), 1);
+  EXPECT_EQ(strtodays("1969-12-31"), -1);
+  EXPECT_EQ(strtodays("2000-01-01"), 10957);
+  // Leap days, including the centuries
+  EXPECT_EQ(strtodays("2020-03-01") - strtodays("2020-02-28"), 2);
+  EXPECT_EQ(strtodays("2021-03-01") - strtodays("2021-02-28"), 1);
+  EXPECT_EQ(strtodays("2000-03-01") - strtodays("2000-02-28"), 2);
+  EXPECT_EQ(strtodays("2100-03-01") - strtodays("2100-02-28"), 1);
+  EXPECT_EQ(strtodays("2021-01-01") - strtodays("2020-01-01"), 366);
+  // Month ends
+  EXPECT_EQ(strtodays("2021-05-01") - strtodays("2021-04-30"), 1);
+  EXPECT_EQ(strtodays("2022-01-01") - strtodays("2021-12-31"), 1);
+  // A datetime is cut to the date
+  EXPECT_EQ(strtodays("2021-10-17T12:00:00"), strtodays("2021-10-17"));
+
+  EXPECT_THROW(strtodays("2021-10"), std::invalid_argument);
+  EXPECT_THROW(strtodays("2021-1O-17"), std::invalid_argument);
+}
+
+TEST(DaysTest, MatchStrToTime) {
+  // The status expiration used to be calculated from the end of the date timestamp
+  for (const char* date : {"1970-01-01", "1999-12-31", "2000-02-29", "2020-02-29", "2021-02-28", "2021-04-30", "2037-12-31"}) {
+    const std::string s {date};
+
+    EXPECT_EQ((strtodays(s) + 1) * 86400L - 1, strtotime(s + " 23:59:59")) << s;
+    EXPECT_EQ(strtodays(s) * 86400L, strtotime(s + " 00:00:00")) << s;
+  }
+}
+
+TEST(DaysTest, GetCurrentDay) {
+  // From UTC-12 up to UTC+14
+  for (long offset : {-43200L, -25200L, -1L, 0L, 1L, 19800L, 50400L}) {
+    // The date may change between the calls, so the day is checked against both of them
+    const int32_t before = strtodays(GetCurrentTimestamp("%Y-%m-%d", offset));
+    const int32_t day = GetCurrentDay(offset);
+    const int32_t after = strtodays(GetCurrentTimestamp("%Y-%m-%d", offset));
+
+    EXPECT_TRUE(day == before || day == after) << offset;
+  }
+
+  // A day before the epoch is rounded down
+  EXPECT_EQ(GetCurrentDay(-std::time(nullptr)), 0);
+  EXPECT_EQ(GetCurrentDay(-std::time(nullptr) - 1), -1);
+  EXPECT_EQ(GetCurrentDay(-std::time(nullptr) - 86400), -1);
+  EXPECT_EQ(GetCurrentDay(-std::time(nullptr) - 86401), -2);
+}
+
+TEST(TimeOffListTest, FindType) {
+  const int32_t day = strtodays("2021-10-17");
+  BambooHrTimeOffList list;
+  list.Add(2, day, "Vacation");
+  list.Add(1, day, "Vacation");
+  list.Add(1, day, "Sick Leave");
+  list.Add(1, day, "Vacation");
+  list.Add(1, day + 1, "Vacation");
+  list.Add(3, day, "Work From Home");
+  list.Add(3, day, "Bereavement");
+  list.Add(3, day, "Sick Leave");
+  list.Sort();
+
+  // Duplicates are removed
+  EXPECT_EQ(list.size(), 7);
+
+  // The smallest type name wins whatever the order of time-offs is
+  ASSERT_NE(list.FindType(1, day), nullptr);
+  EXPECT_EQ(*list.FindType(1, day), "Sick Leave");
+  ASSERT_NE(list.FindType(3, day), nullptr);
+  EXPECT_EQ(*list.FindType(3, day), "Bereavement");
+  ASSERT_NE(list.FindType(2, day), nullptr);
+  EXPECT_EQ(*list.FindType(2, day), "Vacation");
+  ASSERT_NE(list.FindType(1, day + 1), nullptr);
+  EXPECT_EQ(*list.FindType(1, day + 1), "Vacation");
+
+  const auto [first, last] = list.Find(1, day);
+  EXPECT_EQ(std::distance(first, last), 2);
+
+  EXPECT_EQ(list.FindType(1, day - 1), nullptr);
+  EXPECT_EQ(list.FindType(2, day + 1), nullptr);
+  EXPECT_EQ(list.FindType(4, day), nullptr);
+}
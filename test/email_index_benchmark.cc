@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "email_index.h"
+
+using bs::EmailIndex;
+
+/// @brief Generates the employees. The seed is fixed, so runs are comparable.
+static bs::BambooHrUsersList Employees(std::size_t size) {
+  std::mt19937 rng {20211017};
+  std::uniform_int_distribution<int> name(0, 25);
+  bs::BambooHrUsersList users;
+  for (std::size_t i = 0; users.size() < size; ++i) {
+    std::string email {"first."};
+    for (int j = 0; j < 6; ++j) {
+      email.push_back(static_cast<char>('a' + name(rng)));
+    }
+    email += std::to_string(i) + "@example.com";
+    users.emplace(std::move(email), static_cast<int>(i));
+  }
+
+  return users;
+}
+
+/// @brief Gets the emails of the Slack members. Every tenth member is not an employee.
+static std::vector<std::string> Members(const bs::BambooHrUsersList& users) {
+  std::vector<std::string> members;
+  members.reserve(users.size());
+  std::size_t i = 0;
+  for (const auto& user : users) {
+    members.push_back(++i % 10 == 0 ? "guest" + user.first : user.first);
+  }
+  std::shuffle(members.begin(), members.end(), std::mt19937 {20211017});
+
+  return members;
+}
+
+static void BM_EmailIndexBuild(benchmark::State& state) {
+  const auto users = Employees(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(EmailIndex(users));
+  }
+  state.SetItemsProcessed(state.iterations() * users.size());
+}
+
+static void BM_EmailIndexJoin(benchmark::State& state) {
+  const auto users = Employees(state.range(0));
+  const auto members = Members(users);
+  const EmailIndex index {users};
+  for (auto _ : state) {
+    int employee_id = 0;
+    for (const auto& email : members) {
+      benchmark::DoNotOptimize(index.Find(email, &employee_id));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * members.size());
+}
+
+/// @brief The former join which looked every member up in the map of employees
+static void BM_MapJoin(benchmark::State& state) {
+  const auto users = Employees(state.range(0));
+  const auto members = Members(users);
+  for (auto _ : state) {
+    for (const auto& email : members) {
+      benchmark::DoNotOptimize(users.find(email));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * members.size());
+}
+
+// The size of a large Slack workspace
+BENCHMARK(BM_EmailIndexBuild)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EmailIndexJoin)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MapJoin)->Arg(100000)->Unit(benchmark::kMillisecond);
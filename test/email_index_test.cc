@@ -0,0 +1,93 @@
+#include <random>
+#include <string>
+#include "test.h"
+#include "email_index.h"
+
+using bs::EmailIndex;
+
+TEST(EmailIndexTest, FindsEmailsInAnyCase) {
+  const EmailIndex index({{"Jane.Doe@Example.com", 1}, {"john@example.com", 2}});
+  int employee_id = 0;
+
+  EXPECT_EQ(index.size(), 2u);
+  ASSERT_TRUE(index.Find("jane.doe@example.com", &employee_id));
+  EXPECT_EQ(employee_id, 1);
+  ASSERT_TRUE(index.Find("JOHN@EXAMPLE.COM", &employee_id));
+  EXPECT_EQ(employee_id, 2);
+}
+
+TEST(EmailIndexTest, MissesUnknownEmails) {
+  const EmailIndex index({{"jane@example.com", 1}});
+  int employee_id = 42;
+
+  EXPECT_FALSE(index.Find("jane@example.org", &employee_id));
+  EXPECT_FALSE(index.Find("jane@example.co", &employee_id));
+  EXPECT_FALSE(index.Find("", &employee_id));
+  EXPECT_EQ(employee_id, 42);
+}
+
+TEST(EmailIndexTest, SkipsEmptyEmails) {
+  const EmailIndex index({{"", 1}, {"jane@example.com", 2}});
+  int employee_id = 0;
+
+  EXPECT_EQ(index.size(), 1u);
+  EXPECT_FALSE(index.Find("", &employee_id));
+}
+
+TEST(EmailIndexTest, FirstOfCaseDuplicatesWins) {
+  // The map is ordered, so the upper case email comes first
+  const EmailIndex index({{"JANE@example.com", 1}, {"jane@example.com", 2}});
+  int employee_id = 0;
+
+  EXPECT_EQ(index.size(), 1u);
+  ASSERT_TRUE(index.Find("Jane@Example.com", &employee_id));
+  EXPECT_EQ(employee_id, 1);
+}
+
+TEST(EmailIndexTest, EmptyIndex) {
+  const EmailIndex index {bs::BambooHrUsersList()};
+  int employee_id = 0;
+
+  EXPECT_EQ(index.size(), 0u);
+  EXPECT_FALSE(index.Find("jane@example.com", &employee_id));
+}
+
+TEST(EmailIndexTest, MatchesMapLookup) {
+  std::mt19937 rng {20211017};
+  std::uniform_int_distribution<int> letter('a', 'e');
+  std::uniform_int_distribution<int> length(1, 6);
+
+  // Short emails over a small alphabet make the probe sequences collide
+  bs::BambooHrUsersList users;
+  for (int i = 0; i < 3000; ++i) {
+    std::string email(length(rng), ' ');
+    for (auto& c : email) {
+      c = static_cast<char>(letter(rng));
+    }
+    users.emplace(email + "@x", i);
+  }
+  const EmailIndex index(users);
+  ASSERT_EQ(index.size(), users.size());
+
+  for (const auto& [email, id] : users) {
+    int employee_id = -1;
+    ASSERT_TRUE(index.Find(email, &employee_id)) << email;
+    EXPECT_EQ(employee_id, id) << email;
+  }
+  for (int i = 0; i < 3000; ++i) {
+    std::string email(length(rng), ' ');
+    for (auto& c : email) {
+      c = static_cast<char>(letter(rng) - 'a' + 'A');
+    }
+    std::string lower {email};
+    for (auto& c : lower) {
+      c = static_cast<char>(c - 'A' + 'a');
+    }
+    int employee_id = -1;
+    const auto it = users.find(lower + "@x");
+    EXPECT_EQ(index.Find(email + "@X", &employee_id), it != users.end()) << email;
+    if (it != users.end()) {
+      EXPECT_EQ(employee_id, it->second) << email;
+    }
+  }
+}
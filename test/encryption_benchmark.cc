@@ -0,0 +1,97 @@
+#include <random>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "encryption.h"
+
+using bs::Cipher;
+
+static const std::string kSecret {"0123456789abcdef0123456789abcdef"};
+static const std::string kAad {"TEAM:T0123456789"};
+/// @brief The number of values of a bulk call, e.g. the organizations which are loaded on start
+static constexpr std::size_t kBulkSize {64};
+
+/// @brief Generates random bytes. The seed is fixed, so runs are comparable.
+static std::string RandomBytes(std::size_t size) {
+  std::mt19937 rng {20211017};
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::string data(size, '\0');
+  for (auto& c : data) {
+    c = static_cast<char>(byte(rng));
+  }
+
+  return data;
+}
+
+static void BM_CipherEncrypt(benchmark::State& state) {
+  const Cipher cipher {kSecret};
+  const std::string data {RandomBytes(state.range(0))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cipher.Encrypt(data, kAad));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void BM_FreeEncrypt(benchmark::State& state) {
+  const std::string data {RandomBytes(state.range(0))};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bs::encrypt(data, kSecret));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+static void BM_CipherDecrypt(benchmark::State& state) {
+  const Cipher cipher {kSecret};
+  const std::string encrypted {cipher.Encrypt(RandomBytes(state.range(0)), kAad)};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cipher.Decrypt(encrypted, kAad));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_FreeDecrypt(benchmark::State& state) {
+  const std::string encrypted {bs::encrypt(RandomBytes(state.range(0)), kSecret)};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bs::decrypt(encrypted, kSecret));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_CipherBulkEncrypt(benchmark::State& state) {
+  const Cipher cipher {kSecret};
+  const std::vector<std::string> data(kBulkSize, RandomBytes(state.range(0)));
+  const std::vector<std::string> aad(kBulkSize, kAad);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cipher.Encrypt(data, aad));
+  }
+  state.SetBytesProcessed(state.iterations() * kBulkSize * state.range(0));
+}
+
+static void BM_CipherBulkDecrypt(benchmark::State& state) {
+  const Cipher cipher {kSecret};
+  const std::vector<std::string> aad(kBulkSize, kAad);
+  const std::vector<std::string> encrypted {cipher.Encrypt(std::vector<std::string>(kBulkSize, RandomBytes(state.range(0))), aad)};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cipher.Decrypt(encrypted, aad));
+  }
+  state.SetBytesProcessed(state.iterations() * kBulkSize * state.range(0));
+}
+
+static void BM_FreeBulkDecrypt(benchmark::State& state) {
+  const std::vector<std::string> encrypted(kBulkSize, bs::encrypt(RandomBytes(state.range(0)), kSecret));
+  for (auto _ : state) {
+    for (const auto& value : encrypted) {
+      benchmark::DoNotOptimize(bs::decrypt(value, kSecret));
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kBulkSize * state.range(0));
+}
+
+// From a user token up to a large cached response
+BENCHMARK(BM_CipherEncrypt)->RangeMultiplier(10)->Range(100, 1000000);
+BENCHMARK(BM_FreeEncrypt)->RangeMultiplier(10)->Range(100, 1000000);
+BENCHMARK(BM_CipherDecrypt)->RangeMultiplier(10)->Range(100, 1000000);
+BENCHMARK(BM_FreeDecrypt)->RangeMultiplier(10)->Range(100, 1000000);
+BENCHMARK(BM_CipherBulkEncrypt)->RangeMultiplier(10)->Range(100, 1000000);
+BENCHMARK(BM_CipherBulkDecrypt)->RangeMultiplier(10)->Range(100, 1000000);
+BENCHMARK(BM_FreeBulkDecrypt)->RangeMultiplier(10)->Range(100, 1000000);
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+/// @brief Reads a recorded API response from test/fixtures
+inline std::string ReadFixture(const std::string& name) {
+  std::ifstream file {BS_FIXTURES_DIR + name};
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+
+  return buffer.str();
+}
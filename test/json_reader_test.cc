@@ -0,0 +1,144 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "test.h"
+#include "json_reader.h"
+
+using bs::JsonReader;
+
+/// @brief Reads an object of integers
+static std::vector<std::pair<std::string, int64_t>> ReadIntegers(const std::string& json) {
+  JsonReader reader(json);
+  std::vector<std::pair<std::string, int64_t>> members;
+  std::string key;
+
+  reader.BeginObject();
+  while (reader.NextKey(&key)) {
+    members.emplace_back(key, reader.ReadInteger());
+  }
+
+  return members;
+}
+
+/// @brief Reads an array of integers
+static std::vector<int64_t> ReadArray(const std::string& json) {
+  JsonReader reader(json);
+  std::vector<int64_t> elements;
+
+  reader.BeginArray();
+  while (reader.NextElement()) {
+    elements.push_back(reader.ReadInteger());
+  }
+
+  return elements;
+}
+
+/// @brief Reads a single string value
+static std::string ReadString(const std::string& json) {
+  JsonReader reader(json);
+
+  return reader.ReadString();
+}
+
+TEST(JsonReaderTest, ReadsMembers) {
+  const std::string json {R"({"id": "U1", "deleted": false, "age": -42, "profile": {"email": null}, "bot": true})"};
+  JsonReader reader(json);
+  std::string key;
+
+  reader.BeginObject();
+  ASSERT_TRUE(reader.NextKey(&key));
+  EXPECT_EQ(key, "id");
+  EXPECT_EQ(reader.ReadString(), "U1");
+  ASSERT_TRUE(reader.NextKey(&key));
+  EXPECT_EQ(key, "deleted");
+  EXPECT_FALSE(reader.ReadBool());
+  ASSERT_TRUE(reader.NextKey(&key));
+  EXPECT_EQ(key, "age");
+  EXPECT_EQ(reader.ReadInteger(), -42);
+  ASSERT_TRUE(reader.NextKey(&key));
+  EXPECT_EQ(key, "profile");
+  reader.BeginObject();
+  ASSERT_TRUE(reader.NextKey(&key));
+  EXPECT_EQ(key, "email");
+  EXPECT_EQ(reader.ReadStringOrNull(), "");
+  EXPECT_FALSE(reader.NextKey(&key));
+  ASSERT_TRUE(reader.NextKey(&key));
+  EXPECT_EQ(key, "bot");
+  EXPECT_TRUE(reader.ReadBool());
+  EXPECT_FALSE(reader.NextKey(&key));
+}
+
+TEST(JsonReaderTest, ReadsEmptyContainers) {
+  EXPECT_TRUE(ReadIntegers("{}").empty());
+  EXPECT_TRUE(ReadIntegers(" { \n } ").empty());
+  EXPECT_TRUE(ReadArray("[]").empty());
+  EXPECT_EQ(ReadArray("[1, 2,3]"), (std::vector<int64_t> {1, 2, 3}));
+}
+
+TEST(JsonReaderTest, IgnoresFractionAndExponent) {
+  EXPECT_EQ(ReadArray("[1.5, 2e3, -3.25E-2]"), (std::vector<int64_t> {1, 2, -3}));
+}
+
+TEST(JsonReaderTest, SkipsNestedValues) {
+  const std::string json {R"({"a": [1, {"b": "x\"}"}, [], null], "c": {"d": [true, false]}, "e": 7})"};
+  JsonReader reader(json);
+  std::string key;
+
+  reader.BeginObject();
+  ASSERT_TRUE(reader.NextKey(&key));
+  reader.Skip();
+  ASSERT_TRUE(reader.NextKey(&key));
+  reader.Skip();
+  ASSERT_TRUE(reader.NextKey(&key));
+  EXPECT_EQ(key, "e");
+  EXPECT_EQ(reader.ReadInteger(), 7);
+  EXPECT_FALSE(reader.NextKey(&key));
+}
+
+TEST(JsonReaderTest, RejectsMissingComma) {
+  EXPECT_THROW(ReadIntegers(R"({"a":1 "b":2})"), std::runtime_error);
+  EXPECT_THROW(ReadArray("[1 2]"), std::runtime_error);
+
+  // Values which are skipped are checked the same way
+  JsonReader reader(R"({"a": [1 2]})");
+  std::string key;
+  reader.BeginObject();
+  ASSERT_TRUE(reader.NextKey(&key));
+  EXPECT_THROW(reader.Skip(), std::runtime_error);
+}
+
+TEST(JsonReaderTest, RejectsMisplacedComma) {
+  EXPECT_THROW(ReadIntegers(R"({,"a":1})"), std::runtime_error);
+  EXPECT_THROW(ReadIntegers(R"({"a":1,})"), std::runtime_error);
+  EXPECT_THROW(ReadIntegers(R"({"a":1,,"b":2})"), std::runtime_error);
+  EXPECT_THROW(ReadArray("[,1]"), std::runtime_error);
+  EXPECT_THROW(ReadArray("[1,]"), std::runtime_error);
+}
+
+TEST(JsonReaderTest, RejectsTruncatedInput) {
+  EXPECT_THROW(ReadIntegers(R"({"a":1)"), std::runtime_error);
+  EXPECT_THROW(ReadIntegers(R"({"a")"), std::runtime_error);
+  EXPECT_THROW(ReadArray("[1,"), std::runtime_error);
+  EXPECT_THROW(ReadString(R"("abc)"), std::runtime_error);
+  EXPECT_THROW(ReadString(R"("abc\)"), std::runtime_error);
+  EXPECT_THROW(ReadString(R"("\u12)"), std::runtime_error);
+}
+
+TEST(JsonReaderTest, UnescapesStrings) {
+  EXPECT_EQ(ReadString(R"("a\"b\\c\/d\n\t")"), "a\"b\\c/d\n\t");
+  EXPECT_EQ(ReadString(R"("\u0041\u00e9\u20AC")"), "A\xc3\xa9\xe2\x82\xac");
+  EXPECT_EQ(ReadString(R"("\ud83d\ude00")"), "\xf0\x9f\x98\x80");
+  EXPECT_THROW(ReadString(R"("\x")"), std::runtime_error);
+  EXPECT_THROW(ReadString(R"("\u00g0")"), std::runtime_error);
+}
+
+TEST(JsonReaderTest, ReplacesUnpairedSurrogates) {
+  const std::string replacement {"\xef\xbf\xbd"};
+
+  EXPECT_EQ(ReadString(R"("\ud83d")"), replacement);
+  EXPECT_EQ(ReadString(R"("\ud83dx")"), replacement + "x");
+  EXPECT_EQ(ReadString(R"("\ude00")"), replacement);
+  // The escape after a lone high surrogate is kept
+  EXPECT_EQ(ReadString(R"("\ud83d\u0041")"), replacement + "A");
+  EXPECT_EQ(ReadString(R"("\ud83d\ud83d\ude00")"), replacement + "\xf0\x9f\x98\x80");
+}
@@ -0,0 +1,136 @@
+// gtest goes first, since it uses U as a template parameter name and cpprest defines U() macro
+#include "test.h"
+#include <cstdint>
+#include <string>
+#include "records.h"
+
+using bs::InstallCallback;
+using bs::Org;
+using bs::UserToken;
+
+/// @brief Builds the header of a user token record followed by the raw bytes
+static std::string TokenRecord(const std::string& bytes) {
+  return std::string {static_cast<char>(bs::kRecordVersion), 'T'} + bytes;
+}
+
+/// @brief Builds a callback record whose time is the raw varint
+static std::string CallbackRecord(const std::string& time) {
+  return std::string {static_cast<char>(bs::kRecordVersion), 'C', 1, 'u', 1, 'a', 1, 'o', 1, 's'} + time;
+}
+
+TEST(RecordsTest, OrgRoundTrip) {
+  const Org org {"T1", "acme", "secret", "U1", "xoxp-ignored"};
+  Org decoded;
+
+  ASSERT_TRUE(bs::DecodeRecord(bs::EncodeRecord(org), &decoded));
+  EXPECT_EQ(decoded.bamboohr_org, "acme");
+  EXPECT_EQ(decoded.bamboohr_secret, "secret");
+  EXPECT_EQ(decoded.admin_user, "U1");
+  // The team ID and the admin token are stored separately
+  EXPECT_EQ(decoded.slack_team_id, "");
+  EXPECT_EQ(decoded.admin_token, "");
+}
+
+TEST(RecordsTest, UserTokenRoundTrip) {
+  const UserToken token {std::string(300, 'x'), "users.profile:write"};
+  UserToken decoded;
+
+  ASSERT_TRUE(bs::DecodeRecord(bs::EncodeRecord(token), &decoded));
+  EXPECT_EQ(decoded.access_token, token.access_token);
+  EXPECT_EQ(decoded.scope, token.scope);
+}
+
+TEST(RecordsTest, InstallCallbackRoundTrip) {
+  for (const int64_t time : {int64_t {0}, int64_t {1600000000}, int64_t {-1}, INT64_MAX, INT64_MIN}) {
+    const InstallCallback callback {"https://hooks.slack.com/commands/1", "U1", "acme", "secret", time};
+    InstallCallback decoded;
+
+    ASSERT_TRUE(bs::DecodeRecord(bs::EncodeRecord(callback), &decoded)) << time;
+    EXPECT_EQ(decoded.response_url, callback.response_url);
+    EXPECT_EQ(decoded.admin_user, callback.admin_user);
+    EXPECT_EQ(decoded.bamboohr_org, callback.bamboohr_org);
+    EXPECT_EQ(decoded.bamboohr_secret, callback.bamboohr_secret);
+    EXPECT_EQ(decoded.time, time);
+  }
+}
+
+TEST(RecordsTest, EmptyFields) {
+  UserToken decoded {"stale", "stale"};
+
+  ASSERT_TRUE(bs::DecodeRecord(bs::EncodeRecord(UserToken {"", ""}), &decoded));
+  EXPECT_EQ(decoded.access_token, "");
+  EXPECT_EQ(decoded.scope, "");
+}
+
+TEST(RecordsTest, RejectsTruncatedRecords) {
+  const auto data = bs::EncodeRecord(InstallCallback {"https://hooks.slack.com/1", "U1", "acme", "secret", -1});
+  InstallCallback decoded;
+
+  for (std::size_t size = 0; size < data.size(); ++size) {
+    EXPECT_FALSE(bs::DecodeRecord(std::string_view(data).substr(0, size), &decoded)) << "Size " << size;
+  }
+}
+
+TEST(RecordsTest, RejectsTrailingBytes) {
+  UserToken decoded;
+
+  EXPECT_FALSE(bs::DecodeRecord(bs::EncodeRecord(UserToken {"xoxp", "scope"}) + '\0', &decoded));
+  EXPECT_FALSE(bs::DecodeRecord(TokenRecord(std::string {1, 'a', 0, 0}), &decoded));
+}
+
+TEST(RecordsTest, RejectsOtherTypeAndVersion) {
+  const auto data = bs::EncodeRecord(UserToken {"xoxp", "scope"});
+  Org org;
+  UserToken decoded;
+
+  EXPECT_FALSE(bs::DecodeRecord(data, &org));
+  auto other_version = data;
+  other_version[0] = static_cast<char>(bs::kRecordVersion + 1);
+  EXPECT_FALSE(bs::DecodeRecord(other_version, &decoded));
+}
+
+TEST(RecordsTest, RejectsStringPastTheEnd) {
+  UserToken decoded;
+
+  EXPECT_FALSE(bs::DecodeRecord(TokenRecord(std::string {5, 'a', 'b'}), &decoded));
+  // The length is close to the size limit, so the end of the string would overflow
+  EXPECT_FALSE(bs::DecodeRecord(TokenRecord("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01" "ab"), &decoded));
+}
+
+TEST(RecordsTest, VarintLimits) {
+  InstallCallback decoded;
+
+  // The largest 64-bit value takes 10 bytes, the last of which holds a single bit
+  ASSERT_TRUE(bs::DecodeRecord(CallbackRecord("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01"), &decoded));
+  EXPECT_EQ(static_cast<uint64_t>(decoded.time), UINT64_MAX);
+  EXPECT_FALSE(bs::DecodeRecord(CallbackRecord("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x02"), &decoded));
+  EXPECT_FALSE(bs::DecodeRecord(CallbackRecord("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x7f"), &decoded));
+  EXPECT_FALSE(bs::DecodeRecord(CallbackRecord("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x81\x00"), &decoded));
+  EXPECT_FALSE(bs::DecodeRecord(CallbackRecord("\x80"), &decoded));
+}
+
+TEST(RecordsTest, DecodesJsonRecords) {
+  Org org;
+  ASSERT_TRUE(bs::DecodeRecord(R"({"bamboohr_org":"acme","bamboohr_secret":"s","admin_user":"U1"})", &org));
+  EXPECT_EQ(org.bamboohr_org, "acme");
+  EXPECT_EQ(org.admin_user, "U1");
+
+  UserToken token;
+  ASSERT_TRUE(bs::DecodeRecord(R"({"ok":true,"access_token":"xoxp","scope":"identify"})", &token));
+  EXPECT_EQ(token.access_token, "xoxp");
+  EXPECT_EQ(token.scope, "identify");
+
+  InstallCallback callback;
+  ASSERT_TRUE(bs::DecodeRecord(R"({"response_url":"https://hooks.slack.com/1","time":1600000000})", &callback));
+  EXPECT_EQ(callback.response_url, "https://hooks.slack.com/1");
+  EXPECT_EQ(callback.time, 1600000000);
+}
+
+TEST(RecordsTest, RejectsInvalidJsonRecords) {
+  Org org;
+  UserToken token;
+
+  EXPECT_FALSE(bs::DecodeRecord("{", &org));
+  EXPECT_FALSE(bs::DecodeRecord(R"({"bamboohr_org":"acme"})", &org));
+  EXPECT_FALSE(bs::DecodeRecord(R"({"access_token":1})", &token));
+}
@@ -0,0 +1,84 @@
+// gtest goes first, since it uses U as a template parameter name and cpprest defines U() macro
+#include "test.h"
+#include <memory>
+#include <cpprest/json.h>
+#include "common.h"
+#include "db.h"
+#include "response_cache.h"
+
+using bs::DB;
+using bs::ResponseCache;
+using web::json::value;
+
+/// @brief Builds an entry with a small response body
+static ResponseCache::Entry MakeEntry(const std::string& uri) {
+  value body;
+  body[U("employees")] = value::array(1);
+  body[U("employees")][0][U("workEmail")] = value::string(U("jane@example.com"));
+
+  return {uri, std::make_shared<const value>(std::move(body)), "\"etag\"", "", 1600000000};
+}
+
+TEST(ResponseCacheTest, SharesBodyWithoutCopying) {
+  auto& cache = ResponseCache::GetInstance();
+  const auto stored = MakeEntry("/api/gateway.php/org/v1/reports/custom");
+  cache.Put("shared", stored);
+
+  ResponseCache::Entry first;
+  ResponseCache::Entry second;
+  ASSERT_TRUE(cache.Get("shared", stored.uri, &first));
+  ASSERT_TRUE(cache.Get("shared", stored.uri, &second));
+
+  // Every reader gets the same parsed response
+  EXPECT_EQ(first.body.get(), stored.body.get());
+  EXPECT_EQ(second.body.get(), stored.body.get());
+  EXPECT_EQ(first.etag, stored.etag);
+  EXPECT_EQ(first.fetched_at, stored.fetched_at);
+}
+
+TEST(ResponseCacheTest, ReplacedEntryKeepsReadersBody) {
+  auto& cache = ResponseCache::GetInstance();
+  const std::string uri {"/api/gateway.php/org/v1/time_off/whos_out"};
+  cache.Put("replaced", MakeEntry(uri));
+
+  ResponseCache::Entry old_entry;
+  ASSERT_TRUE(cache.Get("replaced", uri, &old_entry));
+  cache.Put("replaced", MakeEntry(uri));
+
+  ResponseCache::Entry new_entry;
+  ASSERT_TRUE(cache.Get("replaced", uri, &new_entry));
+  EXPECT_NE(new_entry.body.get(), old_entry.body.get());
+  // The body which is still read is not freed by the replacement
+  EXPECT_TRUE(old_entry.body->at(U("employees")).is_array());
+}
+
+TEST(ResponseCacheTest, MissesOtherUri) {
+  auto& cache = ResponseCache::GetInstance();
+  cache.Put("uri", MakeEntry("/api/gateway.php/org/v1/employees/directory"));
+
+  ResponseCache::Entry entry;
+  EXPECT_FALSE(cache.Get("uri", "/api/gateway.php/other/v1/employees/directory", &entry));
+  EXPECT_FALSE(cache.Get("missing", "/api/gateway.php/org/v1/employees/directory", &entry));
+}
+
+TEST(ResponseCacheTest, DropsCorruptPersistentCopy) {
+  // The database is opened on first use, so it's kept in memory
+  bs::app_config.kCryptokey = "secret";
+  bs::app_config.kDbBackend = bs::kStorageMemory;
+  bs::app_config.kBambooHrCachePersistent = true;
+  auto& cache = ResponseCache::GetInstance();
+  const std::string uri {"/api/gateway.php/org/v1/employees/directory"};
+
+  ASSERT_TRUE(DB::GetInstance().PutResponseCache("corrupt", "{\"uri\": \"" + uri + "\", \"body\": "));
+  ResponseCache::Entry entry;
+  EXPECT_FALSE(cache.Get("corrupt", uri, &entry));
+  // The copy is deleted, so it does not fail the next request again
+  std::string data;
+  EXPECT_FALSE(DB::GetInstance().GetResponseCache("corrupt", &data));
+
+  ASSERT_TRUE(DB::GetInstance().PutResponseCache("incomplete", "{\"uri\": \"" + uri + "\"}"));
+  EXPECT_FALSE(cache.Get("incomplete", uri, &entry));
+  EXPECT_FALSE(DB::GetInstance().GetResponseCache("incomplete", &data));
+
+  bs::app_config.kBambooHrCachePersistent = false;
+}
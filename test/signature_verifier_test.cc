@@ -0,0 +1,86 @@
+#include <ctime>
+#include <string>
+#include "test.h"
+#include "encryption.h"
+#include "signature_verifier.h"
+
+using bs::SignatureVerifier;
+
+/// @brief The example of the Slack documentation on verifying requests
+static const std::string kSecret {"8f742231b10e8888abcd99yyyzzz85a5"};
+static const std::string kTimestamp {"1531420618"};
+static const std::string kBody {
+    "token=xyzz0WbapA4vBCDEFasx0q6G&team_id=T1DC2JH3J&team_domain=testteamnow&channel_id=G8PSS9T3V"
+    "&channel_name=foobar&user_id=U2CERLKJA&user_name=roadrunner&command=%2Fwebhook-collect&text="
+    "&response_url=https%3A%2F%2Fhooks.slack.com%2Fcommands%2FT1DC2JH3J%2F397700885554%2F96rGlfmibIGlgcZRskXaIFfN"
+    "&trigger_id=398738663015.47445629121.803a0bc887a14d10d2c447fce8b6703c"
+};
+static const std::string kSignature {"v0=a2114d57b48eac39b9ad189dd8316235a7b4a8d21a10bd27519666489c69b503"};
+static const std::time_t kNow {1531420618};
+
+/// @brief Signs the request the way Slack does
+static std::string Sign(const std::string& timestamp, const std::string& body) {
+  return "v0=" + bs::hmac_sha256("v0:" + timestamp + ":" + body, kSecret);
+}
+
+TEST(SignatureVerifierTest, AcceptsSlackExample) {
+  SignatureVerifier verifier {kSecret};
+
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow), SignatureVerifier::VALID);
+}
+
+TEST(SignatureVerifierTest, RejectsMismatch) {
+  SignatureVerifier verifier {kSecret};
+
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody + "&", kSignature, kNow), SignatureVerifier::MISMATCH);
+  EXPECT_EQ(verifier.Verify("1531420619", kBody, kSignature, kNow), SignatureVerifier::MISMATCH);
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature.substr(0, kSignature.size() - 1), kNow), SignatureVerifier::MISMATCH);
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, "", kNow), SignatureVerifier::MISMATCH);
+  // A request of another secret
+  SignatureVerifier other {kSecret + "0"};
+  EXPECT_EQ(other.Verify(kTimestamp, kBody, kSignature, kNow), SignatureVerifier::MISMATCH);
+}
+
+TEST(SignatureVerifierTest, RejectsStaleTimestamp) {
+  SignatureVerifier verifier {kSecret};
+
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow + SignatureVerifier::kMaxClockSkew + 1), SignatureVerifier::STALE);
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow - SignatureVerifier::kMaxClockSkew - 1), SignatureVerifier::STALE);
+  EXPECT_EQ(verifier.Verify("", kBody, kSignature, kNow), SignatureVerifier::STALE);
+  EXPECT_EQ(verifier.Verify("1531420618x", kBody, kSignature, kNow), SignatureVerifier::STALE);
+  // A stale request is not remembered
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow + SignatureVerifier::kMaxClockSkew), SignatureVerifier::VALID);
+}
+
+TEST(SignatureVerifierTest, RejectsReplay) {
+  SignatureVerifier verifier {kSecret};
+
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow), SignatureVerifier::VALID);
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow), SignatureVerifier::REPLAYED);
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow + 1), SignatureVerifier::REPLAYED);
+  EXPECT_EQ(verifier.Replayed(), 2);
+  // A replayed signature is rejected whatever the body is
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody + "&", kSignature, kNow), SignatureVerifier::REPLAYED);
+  EXPECT_EQ(verifier.Replayed(), 3);
+  // A mismatch is not remembered, so it is not reported as a replay
+  const std::string forged {Sign(kTimestamp, kBody + "&").replace(3, 1, "0")};
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, forged, kNow), SignatureVerifier::MISMATCH);
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, forged, kNow), SignatureVerifier::MISMATCH);
+  EXPECT_EQ(verifier.Replayed(), 3);
+}
+
+TEST(SignatureVerifierTest, EvictsOldestOverCap) {
+  SignatureVerifier verifier {kSecret};
+
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow), SignatureVerifier::VALID);
+  // Fills the memory with other deliveries, so the first one is evicted
+  std::string last;
+  for (std::size_t i = 0; i < SignatureVerifier::kMaxReplayEntries; ++i) {
+    last = "n=" + std::to_string(i);
+    ASSERT_EQ(verifier.Verify(kTimestamp, last, Sign(kTimestamp, last), kNow), SignatureVerifier::VALID);
+  }
+
+  EXPECT_EQ(verifier.Verify(kTimestamp, last, Sign(kTimestamp, last), kNow), SignatureVerifier::REPLAYED);
+  EXPECT_EQ(verifier.Verify(kTimestamp, kBody, kSignature, kNow), SignatureVerifier::VALID);
+  EXPECT_EQ(verifier.Replayed(), 1);
+}
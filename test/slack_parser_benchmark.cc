@@ -0,0 +1,53 @@
+#include <string>
+#include <benchmark/benchmark.h>
+#include <cpprest/json.h>
+#include "allocation_counter.h"
+#include "fixture.h"
+#include "slack_parser.h"
+#include "slackapi_legacy.h"
+
+using web::json::value;
+
+/// @brief Builds a users.list page of the size by repeating the recorded members with unique IDs and emails
+static std::string UsersListPage(std::size_t size) {
+  value page = value::parse(ReadFixture("users_list.json"));
+  const auto recorded = page.at(U("members")).as_array();
+  value members = value::array(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    value member = recorded.at(i % recorded.size());
+    member[U("id")] = value::string("U" + std::to_string(1000000000 + i));
+    if (member.at(U("profile")).has_field(U("email"))) {
+      member[U("profile")][U("email")] = value::string("user" + std::to_string(i) + "@example.com");
+    }
+    members[i] = std::move(member);
+  }
+  page[U("members")] = std::move(members);
+
+  return page.serialize();
+}
+
+static void BM_UsersListReader(benchmark::State& state) {
+  const std::string body {UsersListPage(state.range(0))};
+  allocation_counter::Reset();
+  for (auto _ : state) {
+    bs::SlackUsersList users;
+    benchmark::DoNotOptimize(bs::ReadUsersListPage(body, nullptr, &users));
+  }
+  allocation_counter::Report(state);
+  state.SetBytesProcessed(state.iterations() * body.size());
+}
+
+static void BM_UsersListDom(benchmark::State& state) {
+  const std::string body {UsersListPage(state.range(0))};
+  allocation_counter::Reset();
+  for (auto _ : state) {
+    bs::SlackUsersList users;
+    benchmark::DoNotOptimize(legacy::ReadUsersListPage(body, &users));
+  }
+  allocation_counter::Report(state);
+  state.SetBytesProcessed(state.iterations() * body.size());
+}
+
+// A small workspace and the largest page users.list returns
+BENCHMARK(BM_UsersListReader)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_UsersListDom)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
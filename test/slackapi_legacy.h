@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <cpprest/json.h>
+#include "common.h"
+
+/// @brief The DOM path which read users.list pages before the streaming reader replaced it.
+/// It's kept as the reference for the benchmarks.
+namespace legacy {
+/// @brief Parses a page of the users.list response into a DOM and copies the members out of it
+/// @returns A cursor of the next page or empty string if it is the last one
+inline std::string ReadUsersListPage(const std::string& body, bs::SlackUsersList* users) {
+  using web::json::value;
+
+  value json_response = value::parse(body);
+
+  auto array = json_response.at(U("members")).as_array();
+
+  for (std::size_t i = 0; i < array.size(); ++i) {
+    auto& profileValue = array[i].at(U("profile"));
+    const value& emailValue = profileValue[U("email")];
+
+    // Bots and deleted users should be ignored
+    if (emailValue.is_null() || array[i].at(U("deleted")).as_bool()) {
+      continue;
+    }
+
+    std::string email = emailValue.as_string();
+
+    users->push_back({
+        array[i].at(U("id")).as_string(),
+        email,
+        array[i].at(U("name")).as_string(),
+        profileValue[U("real_name")].as_string(),
+        profileValue[U("status_text")].as_string(),
+        profileValue[U("status_emoji")].as_string(),
+        profileValue[U("status_expiration")].as_integer(),
+        profileValue[U("status_text_canonical")].as_string(),
+        0,
+        array[i].at(U("tz_offset")).as_integer(),
+        array[i].at(U("is_admin")).as_bool()
+            || array[i].at(U("is_owner")).as_bool()
+            || array[i].at(U("is_primary_owner")).as_bool()
+    });
+  }
+
+  return !json_response.at(U("response_metadata")).is_null()
+             && !json_response.at(U("response_metadata")).at(U("next_cursor")).is_null()
+         ? json_response.at(U("response_metadata")).at(U("next_cursor")).as_string()
+         : "";
+}
+} // namespace legacy
@@ -0,0 +1,146 @@
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "test.h"
+#include "storage.h"
+
+using bs::Storage;
+using bs::StorageBatch;
+
+/// @brief Collects the records of a scan
+static std::vector<std::pair<std::string, std::string>> ScanAll(Storage& storage, const std::string& prefix) {
+  std::vector<std::pair<std::string, std::string>> records;
+  EXPECT_TRUE(storage.Scan(prefix, [&records](std::string_view key, std::string_view value) {
+    records.emplace_back(key, value);
+    return true;
+  }));
+
+  return records;
+}
+
+TEST(MemoryStorageTest, PutGetDelete) {
+  auto storage = bs::OpenMemoryStorage();
+  std::string value;
+
+  EXPECT_FALSE(storage->Get("TEAM:T1", &value));
+  ASSERT_TRUE(storage->Put("TEAM:T1", "v1", false));
+  ASSERT_TRUE(storage->Get("TEAM:T1", &value));
+  EXPECT_EQ(value, "v1");
+
+  ASSERT_TRUE(storage->Put("TEAM:T1", std::string("v\0" "2", 3), true));
+  ASSERT_TRUE(storage->Get("TEAM:T1", &value));
+  EXPECT_EQ(value, std::string("v\0" "2", 3));
+
+  ASSERT_TRUE(storage->Delete("TEAM:T1", false));
+  EXPECT_FALSE(storage->Get("TEAM:T1", &value));
+  // Deleting a missing record is not an error
+  EXPECT_TRUE(storage->Delete("TEAM:T1", false));
+}
+
+TEST(MemoryStorageTest, FindTellsMissingRecord) {
+  auto storage = bs::OpenMemoryStorage();
+  std::string value {"stale"};
+  bool found = true;
+
+  ASSERT_TRUE(storage->Find("WIO:T1", &value, &found));
+  EXPECT_FALSE(found);
+
+  ASSERT_TRUE(storage->Put("WIO:T1", "v1", false));
+  ASSERT_TRUE(storage->Find("WIO:T1", &value, &found));
+  EXPECT_TRUE(found);
+  EXPECT_EQ(value, "v1");
+}
+
+TEST(MemoryStorageTest, WriteAppliesBatchInOrder) {
+  auto storage = bs::OpenMemoryStorage();
+  ASSERT_TRUE(storage->Put("USER:T1:U1", "old", false));
+
+  StorageBatch batch;
+  batch.Put("USER:T1:U2", "u2");
+  batch.Delete("USER:T1:U1");
+  batch.Put("USER:T1:U3", "first");
+  batch.Put("USER:T1:U3", "second");
+  batch.Delete("USER:T1:U2");
+  EXPECT_EQ(batch.size(), 5u);
+  ASSERT_TRUE(storage->Write(batch, true));
+
+  EXPECT_EQ(ScanAll(*storage, ""), (std::vector<std::pair<std::string, std::string>> {{"USER:T1:U3", "second"}}));
+
+  batch.Clear();
+  EXPECT_EQ(batch.size(), 0u);
+  EXPECT_TRUE(storage->Write(batch, false));
+}
+
+TEST(MemoryStorageTest, ScanVisitsPrefixInKeyOrder) {
+  auto storage = bs::OpenMemoryStorage();
+  for (const auto& key : {"USER:T2:U1", "TEAM:T1", "USER:T1:U2", "USER:T1:U1", "USERS", "USE", "WIO:T1"}) {
+    ASSERT_TRUE(storage->Put(key, key, false));
+  }
+
+  const auto users = ScanAll(*storage, "USER:");
+  ASSERT_EQ(users.size(), 3u);
+  EXPECT_EQ(users[0].first, "USER:T1:U1");
+  EXPECT_EQ(users[1].first, "USER:T1:U2");
+  EXPECT_EQ(users[2].first, "USER:T2:U1");
+  EXPECT_EQ(users[2].second, "USER:T2:U1");
+
+  EXPECT_EQ(ScanAll(*storage, "").size(), 7u);
+  EXPECT_TRUE(ScanAll(*storage, "ZZZ").empty());
+}
+
+TEST(MemoryStorageTest, ScanStopsWhenVisitorReturnsFalse) {
+  auto storage = bs::OpenMemoryStorage();
+  for (const auto& key : {"A1", "A2", "A3"}) {
+    ASSERT_TRUE(storage->Put(key, "", false));
+  }
+
+  int visited = 0;
+  EXPECT_TRUE(storage->Scan("A", [&visited](std::string_view, std::string_view) {
+    return ++visited < 2;
+  }));
+  EXPECT_EQ(visited, 2);
+}
+
+TEST(MemoryStorageTest, VisitorMayWrite) {
+  auto storage = bs::OpenMemoryStorage();
+  for (const auto& key : {"CB:1", "CB:2", "CB:3"}) {
+    ASSERT_TRUE(storage->Put(key, "v", false));
+  }
+
+  // The scan reads a snapshot, so the records written by the visitor are not visited
+  int visited = 0;
+  EXPECT_TRUE(storage->Scan("CB:", [&](std::string_view key, std::string_view) {
+    ++visited;
+    storage->Delete(std::string(key), false);
+    storage->Put(std::string(key) + "x", "v", false);
+    return true;
+  }));
+  EXPECT_EQ(visited, 3);
+  EXPECT_EQ(ScanAll(*storage, "CB:").size(), 3u);
+  std::string value;
+  EXPECT_FALSE(storage->Get("CB:1", &value));
+  EXPECT_TRUE(storage->Get("CB:1x", &value));
+}
+
+TEST(MemoryStorageTest, Properties) {
+  auto storage = bs::OpenMemoryStorage();
+  ASSERT_TRUE(storage->Put("key", "value", false));
+  std::string value;
+
+  ASSERT_TRUE(storage->GetProperty(bs::kStoragePropertyStats, &value));
+  EXPECT_EQ(value, "records: 1");
+  ASSERT_TRUE(storage->GetProperty(bs::kStoragePropertyMemoryUsage, &value));
+  EXPECT_EQ(value, "8");
+  EXPECT_FALSE(storage->GetProperty(bs::kStoragePropertyBlockCacheUsage, &value));
+  EXPECT_FALSE(storage->GetProperty("leveldb.stats", &value));
+}
+
+TEST(StorageTest, OpensBackendsByName) {
+  EXPECT_TRUE(bs::IsStorageAvailable(bs::kStorageMemory));
+  EXPECT_TRUE(bs::IsStorageAvailable(bs::kStorageLevelDb));
+  EXPECT_FALSE(bs::IsStorageAvailable("sqlite"));
+
+  EXPECT_NE(bs::OpenStorage(bs::kStorageMemory, "", {}), nullptr);
+  EXPECT_THROW(bs::OpenStorage("sqlite", "", {}), std::runtime_error);
+}
@@ -0,0 +1,44 @@
+#include <string>
+#include <benchmark/benchmark.h>
+#include <cpprest/base_uri.h>
+#include "uri.h"
+#include "uri_legacy.h"
+
+/// @brief A slash command request body as Slack sends it
+static const std::string kPayload {
+    "token=gIkuvaNzQIHg97ATvDxqgjtO&team_id=T0123456789&team_domain=acme&enterprise_id=E0123456789"
+    "&enterprise_name=Acme%20Corp&channel_id=C0123456789&channel_name=general&user_id=U0123456789"
+    "&user_name=jane.doe&command=%2Fwhoisout&text=install+acme+0123456789abcdef0123456789abcdef01234567"
+    "&api_app_id=A0123456789&is_enterprise_install=false"
+    "&response_url=https%3A%2F%2Fhooks.slack.com%2Fcommands%2FT0123456789%2F1234567890123%2F0123456789abcdefABCDEFGH"
+    "&trigger_id=1234567890123.1234567890.0123456789abcdef0123456789abcdef"
+};
+
+/// @brief Parses the form and reads the fields which the command handler uses
+static void BM_FormData(benchmark::State& state) {
+  for (auto _ : state) {
+    FormData form {std::string(kPayload)};
+    benchmark::DoNotOptimize(form.Get("team_id"));
+    benchmark::DoNotOptimize(form.Get("user_id"));
+    benchmark::DoNotOptimize(form.Get("trigger_id"));
+    benchmark::DoNotOptimize(form.Get("response_url"));
+    benchmark::DoNotOptimize(form.Get("text"));
+  }
+  state.SetBytesProcessed(state.iterations() * kPayload.size());
+}
+
+/// @brief The former path: the form is split into a map and the fields are decoded into new strings
+static void BM_LegacySplitQuery(benchmark::State& state) {
+  for (auto _ : state) {
+    auto params = web::uri::split_query(kPayload);
+    benchmark::DoNotOptimize(legacy::url_decode(params["team_id"]));
+    benchmark::DoNotOptimize(legacy::url_decode(params["user_id"]));
+    benchmark::DoNotOptimize(legacy::url_decode(params["trigger_id"]));
+    benchmark::DoNotOptimize(legacy::url_decode(params["response_url"]));
+    benchmark::DoNotOptimize(legacy::url_decode(params["text"]));
+  }
+  state.SetBytesProcessed(state.iterations() * kPayload.size());
+}
+
+BENCHMARK(BM_FormData);
+BENCHMARK(BM_LegacySplitQuery);
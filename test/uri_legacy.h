@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <cpprest/base_uri.h>
+
+/// @brief The copying decoder which was used along with uri::split_query before FormData replaced them.
+/// It's kept as the reference for the benchmarks.
+namespace legacy {
+/// @brief Converts a hex character digit to a decimal value
+inline int hex_char_digit_to_decimal_char(int hex) {
+  if (hex >= '0' && hex <= '9') {
+    return hex - '0';
+  }
+  if (hex >= 'A' && hex <= 'F') {
+    return 10 + (hex - 'A');
+  }
+  if (hex >= 'a' && hex <= 'f') {
+    return 10 + (hex - 'a');
+  }
+  throw web::uri_exception("Invalid hexadecimal digit");
+}
+
+/// @brief Decodes the string into a new one, a character at a time
+inline std::string url_decode(const std::string& encoded) {
+  std::string raw;
+  for (auto iter = encoded.begin(); iter != encoded.end(); ++iter) {
+    if (*iter == '%') {
+      if (++iter == encoded.end()) {
+        throw web::uri_exception("Invalid URI string, two hexadecimal digits must follow '%'");
+      }
+      int decimal_value = hex_char_digit_to_decimal_char(static_cast<int>(*iter)) << 4;
+      if (++iter == encoded.end()) {
+        throw web::uri_exception("Invalid URI string, two hexadecimal digits must follow '%'");
+      }
+      decimal_value += hex_char_digit_to_decimal_char(static_cast<int>(*iter));
+
+      raw.push_back(static_cast<char>(decimal_value));
+    } else if (*iter > 127 || *iter < 0) {
+      throw web::uri_exception("Invalid encoded URI string, must be entirely ascii");
+    } else if (*iter == '+') {
+      raw.push_back(' ');
+    } else {
+      raw.push_back(static_cast<char>(*iter));
+    }
+  }
+  return raw;
+}
+} // namespace legacy
@@ -0,0 +1,146 @@
+// gtest goes first, since it uses U as a template parameter name and cpprest defines U() macro
+#include "test.h"
+#include <cctype>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cpprest/base_uri.h>
+#include "uri.h"
+
+/// @brief Straightforward decoder which copies every field. It's the reference for the in-place decoder.
+/// @returns FALSE if the text is not a valid encoded ASCII string
+static bool ReferenceDecode(const std::string& encoded, std::string* decoded) {
+  decoded->clear();
+  for (std::size_t i = 0; i < encoded.size(); ++i) {
+    const unsigned char c = encoded[i];
+    if (c == '%') {
+      if (i + 2 >= encoded.size()
+          || !std::isxdigit(static_cast<unsigned char>(encoded[i + 1]))
+          || !std::isxdigit(static_cast<unsigned char>(encoded[i + 2]))) {
+        return false;
+      }
+      decoded->push_back(static_cast<char>(std::stoi(encoded.substr(i + 1, 2), nullptr, 16)));
+      i += 2;
+    } else if (c > 127) {
+      return false;
+    } else {
+      decoded->push_back(c == '+' ? ' ' : c);
+    }
+  }
+
+  return true;
+}
+
+/// @brief Splits the form and decodes its fields with the reference decoder
+static bool ReferenceParse(const std::string& text, std::vector<std::pair<std::string, std::string>>* fields) {
+  std::size_t pos = 0;
+  while (pos <= text.size()) {
+    auto end = text.find('&', pos);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+    if (end != pos) {
+      const std::string field {text.substr(pos, end - pos)};
+      const auto eq = field.find('=');
+      std::string name;
+      std::string value;
+      if (!ReferenceDecode(field.substr(0, eq), &name)
+          || (eq != std::string::npos && !ReferenceDecode(field.substr(eq + 1), &value))) {
+        return false;
+      }
+      fields->emplace_back(std::move(name), std::move(value));
+    }
+    pos = end + 1;
+  }
+
+  return true;
+}
+
+/// @brief Generates a form from the characters which are special to the decoder
+static std::string RandomForm(std::mt19937& rng) {
+  static const std::string alphabet {"%+&=aZ09fF.\x7f\x80\xff"};
+  std::uniform_int_distribution<std::size_t> length(0, 24);
+  std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+
+  std::string form(length(rng), ' ');
+  for (auto& c : form) {
+    c = alphabet[pick(rng)];
+  }
+
+  return form;
+}
+
+TEST(UrlDecodeTest, DecodesEscapesAndPlus) {
+  EXPECT_EQ(url_decode("a+b%20c%2Bd"), "a b c+d");
+  EXPECT_EQ(url_decode("%e2%9C%93"), "\xe2\x9c\x93");
+  EXPECT_EQ(url_decode(""), "");
+}
+
+TEST(UrlDecodeTest, RejectsInvalidEncoding) {
+  EXPECT_THROW(url_decode("%"), web::uri_exception);
+  EXPECT_THROW(url_decode("abc%2"), web::uri_exception);
+  EXPECT_THROW(url_decode("%zz"), web::uri_exception);
+  EXPECT_THROW(url_decode("caf\xc3\xa9"), web::uri_exception);
+}
+
+TEST(FormDataTest, ParsesFields) {
+  FormData form {"team_id=T1&text=who+is%20out&&flag&empty=&team_id=T2"};
+
+  EXPECT_EQ(form.size(), 5u);
+  EXPECT_EQ(form.Get("team_id"), "T1");
+  EXPECT_EQ(form.Get("text"), "who is out");
+  EXPECT_TRUE(form.Has("flag"));
+  EXPECT_EQ(form.Get("flag"), "");
+  EXPECT_TRUE(form.Has("empty"));
+  EXPECT_FALSE(form.Has("missing"));
+  EXPECT_EQ(form.Get("missing"), "");
+}
+
+TEST(FormDataTest, DecodesNames) {
+  FormData form {"a%5Bb%5D=1&c+d=2"};
+
+  EXPECT_EQ(form.Get("a[b]"), "1");
+  EXPECT_EQ(form.Get("c d"), "2");
+}
+
+TEST(FormDataTest, EscapesDoNotSplitFields) {
+  FormData form {"text=a%26b%3Dc&next=1"};
+
+  EXPECT_EQ(form.size(), 2u);
+  EXPECT_EQ(form.Get("text"), "a&b=c");
+  EXPECT_EQ(form.Get("next"), "1");
+}
+
+TEST(FormDataTest, RejectsTruncatedEscapeAtFieldEnd) {
+  // The escape must not borrow the separator or the next field
+  EXPECT_THROW(FormData("a=%2&b=1"), web::uri_exception);
+  EXPECT_THROW(FormData("a=1%"), web::uri_exception);
+}
+
+TEST(FormDataTest, MatchesReferenceDecoder) {
+  std::mt19937 rng {20211017};
+
+  for (int i = 0; i < 200000; ++i) {
+    const std::string text {RandomForm(rng)};
+    std::vector<std::pair<std::string, std::string>> expected;
+    const bool valid = ReferenceParse(text, &expected);
+
+    if (!valid) {
+      EXPECT_THROW(FormData {std::string(text)}, web::uri_exception) << "Form: " << text;
+      continue;
+    }
+
+    FormData form {std::string(text)};
+    ASSERT_EQ(form.size(), expected.size()) << "Form: " << text;
+    // Only the first of the duplicate names is returned
+    std::set<std::string> seen;
+    for (const auto& [name, value] : expected) {
+      ASSERT_TRUE(form.Has(name)) << "Form: " << text;
+      if (seen.insert(name).second) {
+        ASSERT_EQ(form.Get(name), value) << "Form: " << text;
+      }
+    }
+  }
+}